@@ -0,0 +1,169 @@
+#include "BenchmarkPlay.h"
+#include "StudentWorld.h"
+#include "Actor.h"
+#include "GameConstants.h"
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+using namespace std;
+
+// Measures how the cost of a StudentWorld tick grows with large actor populations, with the actors kept where they
+// were made and with them moved along a Z-order curve (see StudentWorld::setActorOrder)
+// Build with -DMARBLE_MADNESS_BENCHMARKS=ON, then run: ActorStorageBenchmark [ticks]
+
+// Counts the hardware cache misses of the calling thread, where the platform and its permissions allow it
+// (Linux perf events); elsewhere, or on a machine without the counter, available() is false
+class CacheMissCounter
+{
+public:
+    CacheMissCounter() : m_fd(-1)
+    {
+#ifdef __linux__
+        perf_event_attr attributes;
+        memset(&attributes, 0, sizeof(attributes));
+        attributes.size = sizeof(attributes);
+        attributes.type = PERF_TYPE_HARDWARE;
+        attributes.config = PERF_COUNT_HW_CACHE_MISSES;
+        attributes.disabled = 1;
+        attributes.exclude_kernel = 1;
+        attributes.exclude_hv = 1;
+        m_fd = syscall(SYS_perf_event_open, &attributes, 0, -1, -1, 0);
+#endif
+    }
+    
+    ~CacheMissCounter()
+    {
+#ifdef __linux__
+        if (m_fd >= 0)
+            close(m_fd);
+#endif
+    }
+    
+    bool available() const { return m_fd >= 0; }
+    
+    void start()
+    {
+#ifdef __linux__
+        if (m_fd >= 0)
+        {
+            ioctl(m_fd, PERF_EVENT_IOC_RESET, 0);
+            ioctl(m_fd, PERF_EVENT_IOC_ENABLE, 0);
+        }
+#endif
+    }
+    
+    // Returns the misses since start, or -1 if the counter is not available
+    long long stop()
+    {
+        long long misses = -1;
+#ifdef __linux__
+        if (m_fd >= 0)
+        {
+            ioctl(m_fd, PERF_EVENT_IOC_DISABLE, 0);
+            if (read(m_fd, &misses, sizeof(misses)) != sizeof(misses))
+                misses = -1;
+        }
+#endif
+        return misses;
+    }
+private:
+    int m_fd;
+    
+    CacheMissCounter(const CacheMissCounter&);
+    CacheMissCounter& operator=(const CacheMissCounter&);
+};
+
+static bool isOpen(StudentWorld& world, int x, int y)
+{
+    return world.attributesAt(x, y) == 0 && ! world.getPlayer()->isAt(x, y);
+}
+
+// Run a headless level crowded with ThiefBots and pea traffic, returning the average milliseconds per tick, the
+// cache misses per tick (-1 where they can't be counted) and what the level allocated, so a run without pea traffic
+// shows up in the results
+static double timeTicks(int population, int ticks, StudentWorld::ActorOrder order, long long& cacheMisses, StudentWorld::AllocationCounts& counts)
+{
+    StudentWorld world(ASSETS_PATH);
+    world.setRandomSeed(BENCHMARK_SEED);
+    if (world.init() != GWSTATUS_CONTINUE_GAME)
+        return -1;
+    
+    for (int placed = 0; placed < population; )
+    {
+        int x = world.randInt(1, VIEW_WIDTH - 2);
+        int y = world.randInt(1, VIEW_HEIGHT - 2);
+        if (isOpen(world, x, y) || world.hasAttributeAt<Actor::COUNTED_BY_FACTORIES>(x, y))
+        {
+            world.addActor(world.newThiefBot(x, y));
+            placed++;
+        }
+    }
+    
+    world.setActorOrder(order);
+    
+    int playerX = world.getPlayer()->getX();
+    int playerY = world.getPlayer()->getY();
+    CacheMissCounter counter;
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    counter.start();
+    
+    for (int t = 0; t < ticks; t++)
+    {
+        // Horizontal peas never start in the player's row and vertical peas never start in the player's column,
+        // so the player survives the whole run. Peas may start on any square but a wall, so a crowded board still
+        // gets its share of peas, which then hit the ThiefBots they start on.
+        for (int i = 0; i < population / 10; i++)
+        {
+            int x = world.randInt(1, VIEW_WIDTH - 2);
+            int y = world.randInt(1, VIEW_HEIGHT - 2);
+            bool horizontal = world.randInt(0, 1) == 0;
+            if ((horizontal && y == playerY) || ( ! horizontal && x == playerX) || world.getTerrainImageAt(x, y) == IID_WALL)
+                continue;
+            int dir = horizontal ? (world.randInt(0, 1) ? GraphObject::right : GraphObject::left) : (world.randInt(0, 1) ? GraphObject::up : GraphObject::down);
+            world.firePea(x, y, dir);
+        }
+        
+        if (world.move() != GWSTATUS_CONTINUE_GAME)
+            break;
+    }
+    
+    long long misses = counter.stop();
+    double elapsed = millisecondsSince(start);
+    cacheMisses = misses < 0 ? -1 : misses / ticks;
+    counts = world.getAllocationCounts();
+    world.cleanUp();
+    return elapsed / ticks;
+}
+
+int main(int argc, char* argv[])
+{
+    int ticks = argc > 1 ? atoi(argv[1]) : 500;
+    const int populations[] = { 100, 1000, 5000 };
+    const StudentWorld::ActorOrder orders[] = { StudentWorld::INSERTION_ORDER, StudentWorld::SPATIAL_ORDER };
+    const char* const orderNames[] = { "insertion", "Z-order" };
+    
+    cout << "Tick cost (" << ticks << " ticks; cache misses are n/a where the hardware counter can't be read)" << endl;
+    cout << setw(10) << "actors" << setw(12) << "order" << setw(16) << "ms per tick" << setw(18) << "misses per tick"
+         << setw(16) << "peas fired" << setw(16) << "bots from heap" << endl;
+    for (int population : populations)
+        for (int i = 0; i != 2; i++)
+        {
+            long long misses;
+            StudentWorld::AllocationCounts counts;
+            double tickTime = timeTicks(population, ticks, orders[i], misses, counts);
+            cout << setw(10) << population << setw(12) << orderNames[i] << setw(16) << tickTime;
+            if (misses < 0)
+                cout << setw(18) << "n/a";
+            else
+                cout << setw(18) << misses;
+            cout << setw(16) << counts.peasFired << setw(16) << counts.thiefBotsFromHeap << endl;
+        }
+}
@@ -0,0 +1,98 @@
+#ifndef BENCHMARKPLAY_H_
+#define BENCHMARKPLAY_H_
+
+#include "StudentWorld.h"
+#include "GameConstants.h"
+#include <vector>
+#include <chrono>
+#include <cstdint>
+
+// Headless play shared by the benchmarks and checks that need a level in full swing
+// Everything a tick does depends only on the world's own state and tick number, so two worlds in the same state
+// (ex: a world and its fork, or a world and a loaded snapshot of it) play on identically
+
+inline double millisecondsSince(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Every run is seeded the same, so the benchmarks always play the same games, from one run and one build to the next
+const unsigned long long BENCHMARK_SEED = 1;
+
+// level01 has ThiefBot and MeanThiefBot factories next to goodies for their ThiefBots to steal
+const int BUSY_LEVEL = 1;
+
+// Starts the given level from a fixed seed, returning init's status
+inline int startLevel(StudentWorld& world, int level, unsigned long long seed)
+{
+    world.setRandomSeed(seed);
+
+    for (int i = 0; i < level; i++)
+        world.advanceToNextLevel();
+
+    return world.init();
+}
+
+// The player walks a fixed loop, firing between steps, so the script depends only on the tick
+inline int scriptedKey(int tick)
+{
+    static const int KEYS[] = { KEY_PRESS_RIGHT, KEY_PRESS_SPACE, KEY_PRESS_DOWN, KEY_PRESS_SPACE, KEY_PRESS_DOWN, KEY_PRESS_SPACE,
+                                KEY_PRESS_LEFT, KEY_PRESS_SPACE, KEY_PRESS_UP, KEY_PRESS_SPACE, KEY_PRESS_UP, KEY_PRESS_SPACE };
+    return KEYS[tick % (sizeof(KEYS) / sizeof(KEYS[0]))];
+}
+
+// Squares holding a goodie; the number only goes up when a dying ThiefBot drops the goodie it carried
+inline int countGoodieSquares(const StudentWorld& world)
+{
+    int squares = 0;
+
+    for (int x = 0; x < VIEW_WIDTH; x++)
+        for (int y = 0; y < VIEW_HEIGHT; y++)
+            if (world.hasAttributeAt<Actor::STOLEN_BY_THIEFBOTS>(x, y))
+                squares++;
+
+    return squares;
+}
+
+// Every few ticks, a pea appears on each ThiefBot's square, heading away from the player
+// Peas are the only thing that kills ThiefBots, so this keeps ThiefBots dying (and dropping what they carry) during
+// the pea phase of the tick, with new ones coming from the factories and the pools
+const int HARASS_INTERVAL = 6;
+
+inline void harassThiefBots(StudentWorld& world)
+{
+    if (world.getTick() % HARASS_INTERVAL != 0)
+        return;
+
+    int playerX = world.getPlayer()->getX();
+
+    for (int x = 0; x < VIEW_WIDTH; x++)
+        for (int y = 0; y < VIEW_HEIGHT; y++)
+            if (world.hasAttributeAt<Actor::COUNTED_BY_FACTORIES>(x, y))
+                world.firePea(x, y, x < playerX ? GraphObject::left : GraphObject::right);
+}
+
+// Plays one scripted tick, returning move's status
+inline int playTick(StudentWorld& world)
+{
+    harassThiefBots(world);
+    world.pressKey(scriptedKey(world.getTick()));
+    return world.move();
+}
+
+// Plays up to "ticks" scripted ticks, recording the state hash after each one, and stops early if the level ends
+inline std::vector<std::uint64_t> play(StudentWorld& world, int ticks)
+{
+    std::vector<std::uint64_t> hashes;
+
+    for (int t = 0; t < ticks; t++)
+    {
+        if (playTick(world) != GWSTATUS_CONTINUE_GAME)
+            break;
+        hashes.push_back(world.getStateHash());
+    }
+
+    return hashes;
+}
+
+#endif // BENCHMARKPLAY_H_
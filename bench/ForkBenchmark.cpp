@@ -0,0 +1,104 @@
+#include "BenchmarkPlay.h"
+#include "StudentWorld.h"
+#include "GameConstants.h"
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+using namespace std;
+
+// Times StudentWorld::fork() against a fresh init() of the same level, and checks that forks replay their parent
+// Build with -DMARBLE_MADNESS_BENCHMARKS=ON, then run: ForkBenchmark [forks]
+
+// Ticks played before forking, so the level is in full swing, and ticks each fork is played for
+const int WARMUP_TICKS = 200;
+const int LOOKAHEAD_TICKS = 20;
+
+// The replay check forks the world before every one of these ticks
+const int CHECK_TICKS = 3000;
+
+// Forks the world before each scripted tick, and checks that every fork plays on as "expected" says the world does
+// Returns the number of forks that did not, and counts the goodies dropped by dying ThiefBots along the way
+static int checkForks(StudentWorld& world, const vector<uint64_t>& expected, int& drops)
+{
+    int mismatches = 0;
+    int goodies = countGoodieSquares(world);
+    drops = 0;
+
+    for (int t = 0; t < CHECK_TICKS; t++)
+    {
+        StudentWorld* child = world.fork();
+        vector<uint64_t> childHashes = play(*child, LOOKAHEAD_TICKS);
+        delete child;
+
+        int end = min<int>(t + LOOKAHEAD_TICKS, expected.size());
+        if (t > end || childHashes != vector<uint64_t>(expected.begin() + t, expected.begin() + end))
+            mismatches++;
+
+        if (playTick(world) != GWSTATUS_CONTINUE_GAME)
+            break;
+
+        int now = countGoodieSquares(world);
+        if (now > goodies)
+            drops++;
+        goodies = now;
+    }
+
+    return mismatches;
+}
+
+int main(int argc, char* argv[])
+{
+    int forks = argc > 1 ? atoi(argv[1]) : 10000;
+
+    StudentWorld parent(ASSETS_PATH);
+    if (startLevel(parent, BUSY_LEVEL, BENCHMARK_SEED) != GWSTATUS_CONTINUE_GAME)
+        return 1;
+    play(parent, WARMUP_TICKS);
+
+    // Fork and throw the fork away, as a lookahead search does with the positions it has finished with
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    for (int i = 0; i < forks; i++)
+        delete parent.fork();
+    double forkTime = millisecondsSince(start);
+
+    // Building a new world from the level file, for comparison
+    start = chrono::steady_clock::now();
+    for (int i = 0; i < forks; i++)
+    {
+        StudentWorld* fresh = new StudentWorld(ASSETS_PATH);
+        startLevel(*fresh, BUSY_LEVEL, BENCHMARK_SEED);
+        delete fresh;
+    }
+    double initTime = millisecondsSince(start);
+
+    cout << "Cost per world (us, " << forks << " worlds)" << endl;
+    cout << setw(16) << "fork + delete" << setw(16) << "new + init" << endl;
+    cout << setw(16) << forkTime * 1000 / forks << setw(16) << initTime * 1000 / forks << endl;
+    parent.cleanUp();
+
+    // A reference world records how the scripted game goes, then a second world plays it again, forking before every
+    // tick. Forks are headless and the script depends only on the tick, so each fork must play on as the reference did,
+    // through the player's moves and shots, ThiefBots made from the pools, stolen goodies and factory censuses.
+    StudentWorld reference(ASSETS_PATH);
+    startLevel(reference, BUSY_LEVEL, BENCHMARK_SEED);
+    vector<uint64_t> expected = play(reference, CHECK_TICKS + LOOKAHEAD_TICKS);
+    reference.cleanUp();
+
+    StudentWorld world(ASSETS_PATH);
+    startLevel(world, BUSY_LEVEL, BENCHMARK_SEED);
+    int drops;
+    int mismatches = checkForks(world, expected, drops);
+    StudentWorld::AllocationCounts counts = world.getAllocationCounts();
+    world.cleanUp();
+
+    cout << endl << "Forks replay their parent for " << LOOKAHEAD_TICKS << " ticks, forking before each of " << CHECK_TICKS
+         << " ticks: " << (mismatches == 0 ? "yes" : "NO") << endl;
+    cout << "  (" << counts.thiefBotsMade << " ThiefBots and " << counts.meanThiefBotsMade << " MeanThiefBots made, "
+         << drops << " carried goodies dropped)" << endl;
+
+    // A game without dropped goodies would not have tested forking a ThiefBot that carries one
+    return mismatches == 0 && drops > 0 ? 0 : 1;
+}
@@ -0,0 +1,150 @@
+#include "Random.h"
+#include "Actor.h"
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <cmath>
+#include <cstdlib>
+using namespace std;
+
+// Checks that drawing the waiting time to the next success (Random::trialsUntilSuccess) gives the same outcomes
+// as rolling nextInt(1, n) == 1 on every trial, for the ThiefBot factory births and the ThiefBot steals
+// Build with -DMARBLE_MADNESS_BENCHMARKS=ON, then run: RandomSamplingCheck [samples] [seed]
+// Exits with a nonzero status if either comparison fails a chi-square test at the 0.1% level
+
+// Two-sample chi-square statistic for two histograms of the same number of samples
+// Bins with too few samples to test are merged into the bin after them
+static double chiSquare(const vector<int>& a, const vector<int>& b, int& degreesOfFreedom)
+{
+    double statistic = 0;
+    int size = static_cast<int>(a.size());
+    int bins = 0;
+    long pendingA = 0, pendingB = 0;
+
+    for (int i = 0; i != size; i++)
+    {
+        pendingA += a[i];
+        pendingB += b[i];
+
+        if (pendingA + pendingB == 0 || (pendingA + pendingB < 20 && i + 1 != size))
+            continue;
+
+        double difference = pendingA - pendingB;
+        statistic += difference * difference / (pendingA + pendingB);
+        pendingA = pendingB = 0;
+        bins++;
+    }
+
+    degreesOfFreedom = bins - 1;
+    return statistic;
+}
+
+// Upper 0.1% point of the chi-square distribution (Wilson-Hilferty approximation)
+static double criticalValue(int degreesOfFreedom)
+{
+    const double z = 3.0902;
+    double k = degreesOfFreedom;
+    double term = 1 - 2 / (9 * k) + z * sqrt(2 / (9 * k));
+    return k * term * term * term;
+}
+
+static bool report(const char* name, const vector<int>& rolled, const vector<int>& skipped, double rolledMean, double skippedMean)
+{
+    int degreesOfFreedom = 0;
+    double statistic = chiSquare(rolled, skipped, degreesOfFreedom);
+    double critical = criticalValue(degreesOfFreedom);
+    bool passed = statistic < critical;
+
+    cout << left << setw(8) << name << right
+         << "  mean (rolled) " << setw(8) << rolledMean
+         << "  mean (skip-ahead) " << setw(8) << skippedMean
+         << "  chi-square " << setw(8) << statistic << " (df " << degreesOfFreedom << ", limit " << critical << ")"
+         << (passed ? "  ok" : "  FAILED") << endl;
+
+    return passed;
+}
+
+// Births in a window of ticks, where the factory only has room for a ThiefBot on some ticks
+// The room pattern stands in for ThiefBots wandering in and out of the factory's area
+static bool hasRoom(int tick)
+{
+    return (tick / 7) % 3 != 0;
+}
+
+static int birthsRolled(Random& random, int ticks)
+{
+    int births = 0;
+
+    for (int tick = 1; tick <= ticks; tick++)
+        if (hasRoom(tick) && random.nextInt(1, FACTORY_BIRTH_ODDS) == 1)
+            births++;
+
+    return births;
+}
+
+static int birthsSkipped(Random& random, int ticks)
+{
+    int births = 0;
+
+    for (int tick = random.trialsUntilSuccess(FACTORY_BIRTH_ODDS); tick <= ticks; tick += random.trialsUntilSuccess(FACTORY_BIRTH_ODDS))
+        if (hasRoom(tick))
+            births++;
+
+    return births;
+}
+
+// Attempts a ThiefBot makes on a goodie until it steals it
+static int attemptsRolled(Random& random)
+{
+    int attempts = 1;
+
+    while (random.nextInt(1, THIEFBOT_STEAL_ODDS) != 1)
+        attempts++;
+
+    return attempts;
+}
+
+int main(int argc, char* argv[])
+{
+    int samples = (argc > 1) ? atoi(argv[1]) : 100000;
+    unsigned long long seed = (argc > 2) ? strtoull(argv[2], nullptr, 10) : 1;
+
+    // The two methods draw from independent streams of the same generator
+    Random rolledRandom(seed);
+    Random skippedRandom = rolledRandom.split();
+
+    const int WINDOW = 500;
+    const int MAX_BIRTHS = 40;
+    const int MAX_ATTEMPTS = 100;
+
+    vector<int> rolledBirths(MAX_BIRTHS + 1), skippedBirths(MAX_BIRTHS + 1);
+    vector<int> rolledAttempts(MAX_ATTEMPTS + 1), skippedAttempts(MAX_ATTEMPTS + 1);
+    double rolledBirthSum = 0, skippedBirthSum = 0, rolledAttemptSum = 0, skippedAttemptSum = 0;
+
+    for (int i = 0; i < samples; i++)
+    {
+        int births = birthsRolled(rolledRandom, WINDOW);
+        rolledBirths[min(births, MAX_BIRTHS)]++;
+        rolledBirthSum += births;
+
+        births = birthsSkipped(skippedRandom, WINDOW);
+        skippedBirths[min(births, MAX_BIRTHS)]++;
+        skippedBirthSum += births;
+
+        int attempts = attemptsRolled(rolledRandom);
+        rolledAttempts[min(attempts, MAX_ATTEMPTS)]++;
+        rolledAttemptSum += attempts;
+
+        attempts = skippedRandom.trialsUntilSuccess(THIEFBOT_STEAL_ODDS);
+        skippedAttempts[min(attempts, MAX_ATTEMPTS)]++;
+        skippedAttemptSum += attempts;
+    }
+
+    cout << fixed << setprecision(3);
+    cout << samples << " samples of births per " << WINDOW << " ticks and attempts per steal" << endl;
+
+    bool passed = report("births", rolledBirths, skippedBirths, rolledBirthSum / samples, skippedBirthSum / samples);
+    passed = report("steals", rolledAttempts, skippedAttempts, rolledAttemptSum / samples, skippedAttemptSum / samples) && passed;
+
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,122 @@
+#include "BenchmarkPlay.h"
+#include "StudentWorld.h"
+#include "GameConstants.h"
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+using namespace std;
+
+// Times StudentWorld::saveSnapshot() and loadSnapshot() on a level in full swing, and checks that a loaded snapshot
+// plays on exactly as the world it was saved from
+// Build with -DMARBLE_MADNESS_BENCHMARKS=ON, then run: SnapshotBenchmark [snapshots]
+
+// Ticks played before saving, so the level is in full swing, and ticks each loaded world is played for
+const int WARMUP_TICKS = 200;
+const int LOOKAHEAD_TICKS = 20;
+
+// The round-trip check saves and loads the world before every one of these ticks
+const int CHECK_TICKS = 3000;
+
+// Saves the world before each scripted tick and loads the snapshot into another world, which must have the same state
+// and play on as "expected" says the world does
+// Returns the number of snapshots that did not, and counts the goodies dropped by dying ThiefBots along the way
+static int checkSnapshots(StudentWorld& world, const vector<uint64_t>& expected, int& drops)
+{
+    StudentWorld loaded(ASSETS_PATH);
+    vector<unsigned char> buffer;
+    int mismatches = 0;
+    int goodies = countGoodieSquares(world);
+    drops = 0;
+
+    for (int t = 0; t < CHECK_TICKS; t++)
+    {
+        size_t size = world.saveSnapshot(buffer.data(), buffer.size());
+        if (size > buffer.size())
+        {
+            buffer.resize(size);
+            world.saveSnapshot(buffer.data(), buffer.size());
+        }
+
+        // A world whose load failed is left empty, so it is not played
+        if ( ! loaded.loadSnapshot(buffer.data(), size) || loaded.getStateHash() != world.getStateHash())
+            mismatches++;
+        else
+        {
+            vector<uint64_t> loadedHashes = play(loaded, LOOKAHEAD_TICKS);
+            int end = min<int>(t + LOOKAHEAD_TICKS, expected.size());
+            if (t > end || loadedHashes != vector<uint64_t>(expected.begin() + t, expected.begin() + end))
+                mismatches++;
+        }
+
+        if (playTick(world) != GWSTATUS_CONTINUE_GAME)
+            break;
+
+        // The next snapshot is saved right after the drop, with the goodie just put back on the board
+        int now = countGoodieSquares(world);
+        if (now > goodies)
+            drops++;
+        goodies = now;
+    }
+
+    loaded.cleanUp();
+    return mismatches;
+}
+
+int main(int argc, char* argv[])
+{
+    int snapshots = argc > 1 ? atoi(argv[1]) : 10000;
+
+    StudentWorld world(ASSETS_PATH);
+    if (startLevel(world, BUSY_LEVEL, BENCHMARK_SEED) != GWSTATUS_CONTINUE_GAME)
+        return 1;
+    play(world, WARMUP_TICKS);
+
+    // Ask for the size first, then save into a buffer that is reused for every snapshot
+    vector<unsigned char> buffer(world.saveSnapshot(nullptr, 0));
+
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    for (int i = 0; i < snapshots; i++)
+        world.saveSnapshot(buffer.data(), buffer.size());
+    double saveTime = millisecondsSince(start);
+
+    StudentWorld loaded(ASSETS_PATH);
+    bool valid = true;
+
+    start = chrono::steady_clock::now();
+    for (int i = 0; i < snapshots; i++)
+        valid = loaded.loadSnapshot(buffer.data(), buffer.size()) && valid;
+    double loadTime = millisecondsSince(start);
+
+    cout << "Snapshot of " << buffer.size() << " bytes (us, " << snapshots << " snapshots)" << endl;
+    cout << setw(16) << "save" << setw(16) << "load" << endl;
+    cout << setw(16) << saveTime * 1000 / snapshots << setw(16) << loadTime * 1000 / snapshots << endl;
+    loaded.cleanUp();
+    world.cleanUp();
+
+    // A reference world records how the scripted game goes, then a second world plays it again, saving a snapshot
+    // before every tick. Loaded worlds are headless and the script depends only on the tick, so each must play on as
+    // the reference did, through the player's moves and shots, ThiefBots made from the pools, stolen goodies, goodies
+    // dropped during the pea phase and factory censuses.
+    StudentWorld reference(ASSETS_PATH);
+    startLevel(reference, BUSY_LEVEL, BENCHMARK_SEED);
+    vector<uint64_t> expected = play(reference, CHECK_TICKS + LOOKAHEAD_TICKS);
+    reference.cleanUp();
+
+    StudentWorld saved(ASSETS_PATH);
+    startLevel(saved, BUSY_LEVEL, BENCHMARK_SEED);
+    int drops = 0;
+    int mismatches = valid ? checkSnapshots(saved, expected, drops) : CHECK_TICKS;
+    StudentWorld::AllocationCounts counts = saved.getAllocationCounts();
+    saved.cleanUp();
+
+    cout << endl << "Loaded snapshots replay their world for " << LOOKAHEAD_TICKS << " ticks, saving before each of "
+         << CHECK_TICKS << " ticks: " << (mismatches == 0 ? "yes" : "NO") << endl;
+    cout << "  (" << counts.thiefBotsMade << " ThiefBots and " << counts.meanThiefBotsMade << " MeanThiefBots made, "
+         << drops << " carried goodies dropped)" << endl;
+
+    // A game without dropped goodies would not have tested saving a goodie put back during the pea phase
+    return mismatches == 0 && drops > 0 ? 0 : 1;
+}
@@ -2,6 +2,8 @@
 #define ACTOR_H_
 
 #include "GraphObject.h"
+#include "ActorHandle.h"
+#include <cstdlib>
 
 // Students:  Add code to this file, Actor.cpp, StudentWorld.h, and StudentWorld.cpp
 
@@ -18,7 +20,13 @@ const int MEAN_THIEFBOT_INITIAL_HEALTH = 8;
 const int MARBLE_INITIAL_HEALTH = 10;
 const int INITIAL_AMMO = 20;
 
+// Chances of 1 in N
+const int THIEFBOT_STEAL_ODDS = 10;
+const int FACTORY_BIRTH_ODDS = 50;
+
 class StudentWorld;
+class SnapshotWriter;
+class SnapshotReader;
 
 /////////////////////////////////////////////////////////////////////////////////////
 // BASE CLASS FOR ALL ACTORS IN THE GAME
@@ -26,37 +34,76 @@ class StudentWorld;
 class Actor : public GraphObject
 {
 public:
-    Actor(StudentWorld* world, int imageID, double startX, double startY, int dir = 0);
-    
-    void adjustPosFromDir(int dir, double& x, double& y) const;
+    // Attributes that other actors test for, combined into a bitmask that each actor type declares once
+    enum Attribute : unsigned
+    {
+        BLOCKS_MOVEMENT         = 1 << 0,
+        CAN_BE_PUSHED           = 1 << 1,
+        BLOCKS_ROBOT_SIGHT      = 1 << 2,
+        STOLEN_BY_THIEFBOTS     = 1 << 3,
+        ALLOWS_MARBLE_MOVEMENT  = 1 << 4,
+        COUNTED_BY_FACTORIES    = 1 << 5,
+        CAN_BE_SWALLOWED        = 1 << 6,
+        CAN_BE_ATTACKED         = 1 << 7,
+        BLOCKS_PEA_MOVEMENT     = 1 << 8,
+        OCCUPIES_SQUARE         = 1 << 9,   // Set for every actor, so a query can tell an empty square from an occupied one
+        REACTS_TO_VISITORS      = 1 << 10   // Has an onEnter reaction, so arrivals on its square must be reported to it
+    };
+    static const int NUM_ATTRIBUTES = 11;
+    
+    // Position of a single attribute's bit (ex: BLOCKS_ROBOT_SIGHT is bit 2)
+    static constexpr int attributeIndex(unsigned attribute) { return attribute <= 1 ? 0 : 1 + attributeIndex(attribute >> 1); }
+    
+    // Concrete kind of each actor, stored inline so the world can tell actors apart without a virtual call
+    enum Type : unsigned char
+    {
+        AVATAR, RAGEBOT, THIEFBOT, MEAN_THIEFBOT, MARBLE, THIEFBOT_FACTORY, MEAN_THIEFBOT_FACTORY,
+        EXTRA_LIFE_GOODIE, RESTORE_HEALTH_GOODIE, AMMO_GOODIE, CRYSTAL, PIT, EXIT,
+        NUM_TYPES
+    };
+    
+    Actor(StudentWorld* world, Type type, int imageID, int startX, int startY, int dir = 0, unsigned attributes = 0);
+    
+    void adjustPosFromDir(int dir, int& x, int& y) const;
     void move(int dir);
     bool attemptToMove(int dir);
+    virtual void moveTo(int x, int y);
     
     bool isAlive() const { return m_alive; }
-    void setStatus(bool status) { m_alive = status; }
+    void setStatus(bool status);
+    void setDirection(int dir);
+    Type getType() const { return m_type; }
     StudentWorld* getWorld() const { return m_world; }
-    bool isAt(double x, double y) const { return (x == getX() && y == getY()); }
+    
+    // Actors are copied into a forked world as they are and then moved over to it
+    void setWorld(StudentWorld* world) { m_world = world; }
+    
+    // The world's handle for the actor, given out when the actor joins the world
+    ActorHandle getHandle() const { return m_handle; }
+    void setHandle(ActorHandle handle) { m_handle = handle; }
+    bool isAt(int x, int y) const { return (x == getX() && y == getY()); }
     
     // Default implementations for
     virtual void doSomething() {}               // Actor objects that do nothing during a tick
     virtual void damage() {}                    // non-CanBeAttacked objects
     virtual void push() {}                      // non-Marble objects
-    virtual void setCanCollect(bool status) {}  // non-Collectable objects
-    
-    // Test for specific attributes
-    virtual bool blocksMovement() const         { return false; }
-    virtual bool canBePushed() const            { return false; }
-    virtual bool blocksRobotSight() const       { return false; }
-    virtual bool stolenByThiefBots() const      { return false; }
-    virtual bool allowsMarbleMovement() const   { return false; }
-    virtual bool countedByFactories() const     { return false; }
-    virtual bool canBeSwallowed() const         { return false; }
-    virtual bool canBeAttacked() const          { return false; }
-    virtual bool blocksPeaMovement() const      { return false; }
+    virtual void onEnter(Actor* visitor) {}     // objects that do not react when another actor moves onto their square
+    
+    // Test for specific attributes (true if the actor has any of the given attributes)
+    unsigned getAttributes() const { return m_attributes; }
+    bool hasAttribute(unsigned attributes) const { return (m_attributes & attributes) != 0; }
+    
+    // Write or read the state a new actor of the same type and square would not have, after its base class's state
+    // (see StudentWorld::saveSnapshot); the world reads the type and square itself, since it needs them to make the actor
+    virtual void saveState(SnapshotWriter& out) const;
+    virtual void loadState(SnapshotReader& in);
 
     virtual ~Actor() {}
 private:
+    unsigned m_attributes;
+    Type m_type;
     bool m_alive;
+    ActorHandle m_handle;
     StudentWorld* m_world;
 };
 
@@ -66,18 +113,18 @@ private:
 class CanBeAttacked : public Actor
 {
 public:
-    CanBeAttacked(StudentWorld* world, int health, int imageID, double startX, double startY, int dir = 0);
+    static const unsigned ATTRIBUTES = BLOCKS_MOVEMENT | BLOCKS_ROBOT_SIGHT | CAN_BE_ATTACKED;
+    
+    CanBeAttacked(StudentWorld* world, Type type, int health, int imageID, int startX, int startY, int dir = 0, unsigned attributes = 0);
     
     void firePea() const;
     virtual void damage();
     
     int getHealth() const { return m_health; }
-    void setHealth(int amount) { m_health = amount; }
-
-    // Test for specific attributes
-    virtual bool blocksMovement() const     { return true; }
-    virtual bool blocksRobotSight() const   { return true; }
-    virtual bool canBeAttacked() const      { return true; }
+    void setHealth(int amount);
+    
+    virtual void saveState(SnapshotWriter& out) const;
+    virtual void loadState(SnapshotReader& in);
     
     virtual ~CanBeAttacked() {}
 private:
@@ -88,7 +135,7 @@ private:
 class Avatar : public CanBeAttacked
 {
 public:
-    Avatar(StudentWorld* world, double startX, double startY);
+    Avatar(StudentWorld* world, int startX, int startY);
     
     virtual void doSomething();
     
@@ -96,6 +143,9 @@ public:
     void addAmmo(int amount) { m_ammo += amount; }
     int getCrystals() const { return m_crystals; }
     void addCrystal() { m_crystals++; }
+    
+    virtual void saveState(SnapshotWriter& out) const;
+    virtual void loadState(SnapshotReader& in);
 private:
     int m_ammo;
     int m_crystals;
@@ -108,21 +158,29 @@ private:
 class Robot : public CanBeAttacked
 {
 public:
-    Robot(StudentWorld* world, int health, int imageID, double startX, double startY, int dir = 0);
+    Robot(StudentWorld* world, Type type, int health, int imageID, int startX, int startY, int dir = 0, unsigned attributes = 0);
     
-    bool canDoSomething();
+    // Robots rest between actions, so the world only wakes them up on the ticks they act
+    void scheduleActionAt(int tick);
+    void rest();
     bool canFirePea() const;
     
+    int getRestTicks() const { return m_ticks; }
+    int getNextTick() const { return m_nextTick; }
+    
+    virtual void saveState(SnapshotWriter& out) const;
+    virtual void loadState(SnapshotReader& in);
+    
     virtual ~Robot() {}
 private:
     int m_ticks;
-    int m_currentTick;
+    int m_nextTick;
 };
 
 class RageBot : public Robot
 {
 public:
-    RageBot(StudentWorld* world, double startX, double startY, int dir = 0);
+    RageBot(StudentWorld* world, int startX, int startY, int dir = 0);
     
     virtual void doSomething();
 private:
@@ -135,27 +193,38 @@ private:
 class ThiefBot : public Robot
 {
 public:
-    ThiefBot(StudentWorld* world, int health, int imageID, double startX, double startY);
+    static const unsigned ATTRIBUTES = COUNTED_BY_FACTORIES;
+    
+    ThiefBot(StudentWorld* world, Type type, int health, int imageID, int startX, int startY);
 
     virtual void doSomething();
     
-    // Test for specific attributes
-    virtual bool countedByFactories() const { return true; }
+    // The type of the goodie the ThiefBot is carrying, or NUM_TYPES if it has none
+    Type getCarriedGoodie() const { return m_carriedGoodie; }
+    
+    // How far the ThiefBot goes before turning, how far it has gone, and how many steal attempts it has left before one succeeds
+    int getDistanceBeforeTurning() const { return m_distanceBeforeTurning; }
+    int getDistanceTraveled() const { return m_distanceTraveled; }
+    int getRollsBeforeSteal() const { return m_rollsBeforeSteal; }
+    
+    virtual void saveState(SnapshotWriter& out) const;
+    virtual void loadState(SnapshotReader& in);
     
     virtual ~ThiefBot() {}
 private:
     int m_distanceBeforeTurning;
     int m_distanceTraveled;
-    bool m_hasPickedUpGoodie;
-    Actor* m_goodie;
+    int m_rollsBeforeSteal;
+    Type m_carriedGoodie;   // The kind of goodie taken off the board, put back when the ThiefBot dies
     virtual void damageEffect();
+    void dropGoodie();
     virtual bool ableToFirePeas() const { return false; }
 };
 
 class MeanThiefBot : public ThiefBot
 {
 public:
-    MeanThiefBot(StudentWorld* world, double startX, double startY);
+    MeanThiefBot(StudentWorld* world, int startX, int startY);
     
 private:
     virtual bool ableToFirePeas() const { return true; }
@@ -164,14 +233,12 @@ private:
 class Marble : public CanBeAttacked
 {
 public:
-    Marble(StudentWorld* world, double startX, double startY);
+    static const unsigned ATTRIBUTES = CAN_BE_PUSHED | CAN_BE_SWALLOWED;
+    
+    Marble(StudentWorld* world, int startX, int startY);
     
     // Inherits Actor's implementation for doSomething() (doing nothing)
     virtual void push();
-    
-    // Test specific attributes
-    virtual bool canBePushed() const    { return true; }
-    virtual bool canBeSwallowed() const { return true; }
 private:
     virtual void damageEffect();
 };
@@ -182,25 +249,34 @@ private:
 class ThiefBotFactory : public Actor
 {
 public:
-    ThiefBotFactory(StudentWorld* world, double startX, double startY);
+    static const unsigned ATTRIBUTES = BLOCKS_MOVEMENT | BLOCKS_ROBOT_SIGHT | BLOCKS_PEA_MOVEMENT;
+    
+    ThiefBotFactory(StudentWorld* world, int startX, int startY, Type type = THIEFBOT_FACTORY);
 
     virtual void doSomething();
+    void scheduleNextBirth(int lastTick);
+    int getNextBirthTick() const { return m_nextBirthTick; }
+    
+    // The world keeps the factory's census of ThiefBots in its area up to date as they come and go
+    void takeCensus();
+    bool isInCensusArea(int x, int y) const { return abs(x - getX()) <= CENSUS_RADIUS && abs(y - getY()) <= CENSUS_RADIUS; }
+    void changeCensus(int delta) { m_census += delta; }
     
-    // Test specific attributes
-    virtual bool blocksMovement() const     { return true; }
-    virtual bool blocksRobotSight() const   { return true; }
-    virtual bool blocksPeaMovement() const  { return true; }
+    virtual void saveState(SnapshotWriter& out) const;
+    virtual void loadState(SnapshotReader& in);
     
     virtual ~ThiefBotFactory() {}
 private:
-    int countThiefBots();
+    static const int CENSUS_RADIUS = 3;
+    int m_census;
+    int m_nextBirthTick;
     virtual void createNewThiefBot() const;
 };
 
 class MeanThiefBotFactory : public ThiefBotFactory
 {
 public:
-    MeanThiefBotFactory(StudentWorld* world, double startX, double startY);
+    MeanThiefBotFactory(StudentWorld* world, int startX, int startY);
     
 private:
     virtual void createNewThiefBot() const;
@@ -212,25 +288,24 @@ private:
 class Collectable : public Actor
 {
 public:
-    Collectable(StudentWorld* world, int imageID, double startX, double startY);
+    static const unsigned ATTRIBUTES = REACTS_TO_VISITORS;
     
-    virtual void doSomething();
+    Collectable(StudentWorld* world, Type type, int imageID, int startX, int startY, unsigned attributes = 0);
     
-    virtual void setCanCollect(bool status) { m_canCollect = status; }
+    // Inherits Actor's implementation for doSomething() (doing nothing), since collecting happens when the player arrives
+    virtual void onEnter(Actor* visitor);
     
     virtual ~Collectable() {}
 private:
-    bool m_canCollect;
     virtual void giveBenefits() = 0;
 };
 
 class ExtraLifeGoodie : public Collectable
 {
 public:
-    ExtraLifeGoodie(StudentWorld* world, double startX, double startY);
+    static const unsigned ATTRIBUTES = STOLEN_BY_THIEFBOTS;
     
-    // Test specific attributes
-    virtual bool stolenByThiefBots() const { return true; }
+    ExtraLifeGoodie(StudentWorld* world, int startX, int startY);
 private:
     virtual void giveBenefits();
 };
@@ -238,10 +313,9 @@ private:
 class RestoreHealthGoodie : public Collectable
 {
 public:
-    RestoreHealthGoodie(StudentWorld* world, double startX, double startY);
+    static const unsigned ATTRIBUTES = STOLEN_BY_THIEFBOTS;
     
-    // Test specific attributes
-    virtual bool stolenByThiefBots() const { return true; }
+    RestoreHealthGoodie(StudentWorld* world, int startX, int startY);
 private:
     virtual void giveBenefits();
 };
@@ -249,10 +323,9 @@ private:
 class AmmoGoodie : public Collectable
 {
 public:
-    AmmoGoodie(StudentWorld* world, double startX, double startY);
+    static const unsigned ATTRIBUTES = STOLEN_BY_THIEFBOTS;
     
-    // Test specific attributes
-    virtual bool stolenByThiefBots() const { return true; }
+    AmmoGoodie(StudentWorld* world, int startX, int startY);
 private:
     virtual void giveBenefits();
 };
@@ -260,52 +333,38 @@ private:
 class Crystal : public Collectable
 {
 public:
-    Crystal(StudentWorld* world, double startX, double startY);
+    Crystal(StudentWorld* world, int startX, int startY);
 private:
     virtual void giveBenefits();
 };
 
-class Wall : public Actor
-{
-public:
-    Wall(StudentWorld* world, double startX, double startY);
-    
-    // Inherits Actor's implementation for doSomething() (doing nothing)
-    
-    // Test specific attributes
-    virtual bool blocksMovement() const     { return true; }
-    virtual bool blocksRobotSight() const   { return true; }
-    virtual bool blocksPeaMovement() const  { return true; }
-};
-
 class Pit : public Actor
 {
 public:
-    Pit(StudentWorld* world, double startX, double startY);
+    static const unsigned ATTRIBUTES = BLOCKS_MOVEMENT | ALLOWS_MARBLE_MOVEMENT | REACTS_TO_VISITORS;
     
-    virtual void doSomething();
+    Pit(StudentWorld* world, int startX, int startY);
     
-    // Test specific attributes
-    virtual bool blocksMovement() const         { return true; }
-    virtual bool allowsMarbleMovement() const   { return true; }
+    // Inherits Actor's implementation for doSomething() (doing nothing), since it only reacts to a marble arriving
+    virtual void onEnter(Actor* visitor);
 };
 
 class Exit : public Actor
 {
 public:
-    Exit(StudentWorld* world, double startX, double startY);
+    static const unsigned ATTRIBUTES = REACTS_TO_VISITORS;
     
-    virtual void doSomething();
+    Exit(StudentWorld* world, int startX, int startY);
+    
+    // Inherits Actor's implementation for doSomething() (doing nothing), since it only reacts to events
+    virtual void onEnter(Actor* visitor);
+    void reveal();
+    bool isRevealed() const { return m_isVisible; }
+    
+    virtual void saveState(SnapshotWriter& out) const;
+    virtual void loadState(SnapshotReader& in);
 private:
     bool m_isVisible;
 };
 
-class Pea : public Actor
-{
-public:
-    Pea(StudentWorld* world, double startX, double startY, int dir = 0);
-    
-    virtual void doSomething();
-};
-
 #endif // ACTOR_H_
@@ -0,0 +1,33 @@
+#ifndef ACTORHANDLE_H_
+#define ACTORHANDLE_H_
+
+#include <cstdint>
+
+// 32-bit reference to an actor, handed out and resolved by StudentWorld
+// The low bits pick the world's slot for the actor and the high bits hold the slot's generation when the handle
+// was made. Freeing an actor bumps its slot's generation, so an old handle resolves to nullptr instead of dangling,
+// and the world is free to move the actor as long as it updates the slot.
+class ActorHandle
+{
+public:
+    static const int INDEX_BITS = 20;
+    static const int GENERATION_BITS = 32 - INDEX_BITS;
+    static const std::uint32_t INDEX_MASK = (std::uint32_t(1) << INDEX_BITS) - 1;
+    static const std::uint32_t GENERATION_MASK = (std::uint32_t(1) << GENERATION_BITS) - 1;
+
+    // Generation 0 is never handed out, so a default handle refers to nothing
+    ActorHandle() : m_bits(0) {}
+    ActorHandle(std::uint32_t index, std::uint32_t generation)
+    : m_bits((generation & GENERATION_MASK) << INDEX_BITS | (index & INDEX_MASK)) {}
+
+    std::uint32_t index() const         { return m_bits & INDEX_MASK; }
+    std::uint32_t generation() const    { return m_bits >> INDEX_BITS; }
+    bool isNull() const                 { return m_bits == 0; }
+
+    bool operator==(ActorHandle other) const { return m_bits == other.m_bits; }
+    bool operator!=(ActorHandle other) const { return m_bits != other.m_bits; }
+private:
+    std::uint32_t m_bits;
+};
+
+#endif // ACTORHANDLE_H_
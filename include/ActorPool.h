@@ -0,0 +1,75 @@
+#ifndef ACTORPOOL_H_
+#define ACTORPOOL_H_
+
+#include <new>
+#include <utility>
+
+// Free-list pool for one concrete actor type
+// A destroyed object's memory goes on the free list and the next create() reuses it, so once a level has made
+// as many objects as it ever holds at once, making and destroying them no longer touches the heap
+template <class T>
+class ActorPool
+{
+public:
+    ActorPool() : m_free(nullptr), m_made(0), m_fromHeap(0) {}
+
+    // Every object made by the pool must be destroyed by it before the pool goes away
+    ~ActorPool()
+    {
+        while (m_free != nullptr)
+        {
+            Block* next = m_free->next;
+            ::operator delete(m_free);
+            m_free = next;
+        }
+    }
+
+    template <class... Args>
+    T* create(Args&&... args)
+    {
+        void* memory;
+
+        if (m_free != nullptr)
+        {
+            memory = m_free;
+            m_free = m_free->next;
+        }
+        else
+        {
+            memory = ::operator new(sizeof(Block));
+            m_fromHeap++;
+        }
+
+        m_made++;
+        return new (memory) T(std::forward<Args>(args)...);
+    }
+
+    void destroy(T* object)
+    {
+        object->~T();
+        Block* block = reinterpret_cast<Block*>(object);
+        block->next = m_free;
+        m_free = block;
+    }
+
+    // Objects made, and how many of them needed new memory from the heap, since the counts were last reset
+    int made() const        { return m_made; }
+    int fromHeap() const    { return m_fromHeap; }
+    void resetCounts()      { m_made = m_fromHeap = 0; }
+private:
+    union Block
+    {
+        Block* next;
+        alignas(T) unsigned char storage[sizeof(T)];
+    };
+
+    Block* m_free;
+    int m_made;
+    int m_fromHeap;
+
+    // Copying a pool would free the same memory twice
+    ActorPool(const ActorPool&);
+    ActorPool& operator=(const ActorPool&);
+};
+
+#endif // ACTORPOOL_H_
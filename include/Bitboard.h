@@ -0,0 +1,35 @@
+#ifndef BITBOARD_H_
+#define BITBOARD_H_
+
+#include "GameConstants.h"
+#include <cstdint>
+
+// One bit for every square of the maze, packed into 64-bit words
+// Squares are numbered row by row (y * VIEW_WIDTH + x), so a run of squares in a row is a run of bits
+class Bitboard
+{
+public:
+    static const int NUM_SQUARES = VIEW_WIDTH * VIEW_HEIGHT;
+    static const int NUM_WORDS = (NUM_SQUARES + 63) / 64;
+
+    Bitboard() { clear(); }
+
+    static int square(int x, int y) { return y * VIEW_WIDTH + x; }
+
+    void clear()
+    {
+        for (int i = 0; i < NUM_WORDS; i++)
+            m_words[i] = 0;
+    }
+
+    void set(int square)            { m_words[square / 64] |= bit(square); }
+    void reset(int square)          { m_words[square / 64] &= ~bit(square); }
+    bool test(int square) const     { return (m_words[square / 64] & bit(square)) != 0; }
+
+private:
+    std::uint64_t m_words[NUM_WORDS];
+
+    static std::uint64_t bit(int square) { return std::uint64_t(1) << (square % 64); }
+};
+
+#endif // BITBOARD_H_
@@ -21,6 +21,8 @@ const int IID_RESTORE_HEALTH = 11;
 const int IID_EXTRA_LIFE = 12;
 const int IID_AMMO = 13;
 
+const int IID_NONE = -1;
+
 // sounds
 
 const int SOUND_THEME			= 0;
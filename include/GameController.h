@@ -9,6 +9,7 @@
 const int INVALID_KEY = 0;
 
 class GraphObject;
+class GraphObjectRegistry;
 class GameWorld;
 
 class GameController
@@ -48,6 +49,9 @@ class GameController
 
 	void quitGame();
 
+	  // Called by a world as it is destroyed, with whatever GraphObjects it still holds
+	void reportLeakedGraphObjects(const GraphObjectRegistry& graphObjects) const;
+
 	  // Meyers singleton pattern
 	static GameController& getInstance()
 	{
@@ -82,7 +86,6 @@ private:
 	void initDrawersAndSounds();
 	bool passesThruWhenSingleStepping(int key) const;
 	void displayGamePlay();
-	void reportLeakedGraphObjects() const;
 
 };
 
@@ -2,6 +2,7 @@
 #define GAMEWORLD_H_
 
 #include "GameConstants.h"
+#include "GraphObjectRegistry.h"
 #include <string>
 
 const int START_PLAYER_LIVES = 3;
@@ -14,21 +15,48 @@ public:
 
 	GameWorld(std::string assetPath)
 	 : m_lives(START_PLAYER_LIVES), m_score(0), m_level(0),
-	   m_controller(nullptr), m_assetPath(assetPath)
+	   m_controller(nullptr), m_assetPath(assetPath), m_headlessKey(0)
 	{
 	}
 
-	virtual ~GameWorld()
-	{
-	}
+	virtual ~GameWorld();
 
 	virtual int init() = 0;
 	virtual int move() = 0;
 	virtual void cleanUp() = 0;
 
+	  // Image of the static scenery at (x, y) that is drawn without a GraphObject, or IID_NONE
+	virtual int getTerrainImageAt(int /* x */, int /* y */) const
+	{
+		return IID_NONE;
+	}
+
+	  // Moving sprites that are drawn without a GraphObject (ex: peas in flight)
+	virtual int getNumProjectiles() const
+	{
+		return 0;
+	}
+
+	virtual void getProjectile(int /* i */, int& imageID, int& x, int& y, int& direction) const
+	{
+		imageID = IID_NONE;
+		x = y = direction = 0;
+	}
+
+	  // Restart the world's random numbers from the given seed, so a game can be played again exactly
+	virtual void setRandomSeed(unsigned long long /* seed */)
+	{
+	}
+
 	void setGameStatText(std::string text);
 
 	bool getKey(int& value);
+
+	  // Gives a headless world the key its next getKey returns (ex: an AI trying a move in a forked world)
+	void pressKey(int key)
+	{
+		m_headlessKey = key;
+	}
 	void playSound(int soundID);
 
 	int getLevel() const
@@ -78,17 +106,43 @@ public:
 		m_controller = controller;
 	}
 
+	  // The GraphObjects the controller draws, or nullptr for a headless world (one without a controller)
+	GraphObjectRegistry* getGraphObjects()
+	{
+		return m_controller != nullptr ? &m_graphObjects : nullptr;
+	}
+
 	std::string assetPath() const
 	{
 		return m_assetPath;
 	}
 
+protected:
+	  // A copy has the same lives, score and level, but starts out headless, with nothing registered
+	GameWorld(const GameWorld& other)
+	 : m_lives(other.m_lives), m_score(other.m_score), m_level(other.m_level),
+	   m_controller(nullptr), m_assetPath(other.m_assetPath), m_headlessKey(0)
+	{
+	}
+
+	  // Puts back the lives, score and level of a saved game (ex: when a snapshot is loaded)
+	void restoreProgress(int lives, int score, int level)
+	{
+		m_lives = lives;
+		m_score = score;
+		m_level = level;
+	}
+
 private:
 	int				m_lives;
 	int				m_score;
 	int				m_level;
 	GameController* m_controller;
 	std::string		m_assetPath;
+	GraphObjectRegistry m_graphObjects;
+	int				m_headlessKey;
+
+	GameWorld& operator=(const GameWorld&);
 };
 
 #endif // GAMEWORLD_H_
@@ -3,9 +3,7 @@
 
 #include "SpriteManager.h"
 #include "GameConstants.h"
-
-#include <set>
-#include <cmath>
+#include "GraphObjectRegistry.h"
 
 const int ANIMATION_POSITIONS_PER_TICK = 1;
 
@@ -19,21 +17,43 @@ class GraphObject
 	static const int up = 90;
 	static const int down = 270;
 
-	GraphObject(int imageID, double startX, double startY, int dir = 0, double size = 1.0)
+	  // The object adds itself to the registry (if any) and takes itself out again when it is destroyed
+	  // A headless world passes nullptr, since nothing will draw its objects
+	GraphObject(GraphObjectRegistry* registry, int imageID, int startX, int startY, int dir = 0, double size = 1.0)
 	 : m_imageID(imageID), m_visible(true), m_x(startX), m_y(startY),
 	   m_destX(startX), m_destY(startY), m_brightness(1.0),
-	   m_animationNumber(0), m_direction(dir), m_size(size)
+	   m_animationNumber(0), m_direction(dir), m_size(size),
+	   m_registry(registry), m_registryIndex(-1)
 	{
 		if (m_size <= 0)
 			m_size = 1;
 
-		getGraphObjects().insert(this);
+		if (m_registry != nullptr)
+			m_registryIndex = m_registry->add(this);
 		setVisible(true);
 	}
 
 	virtual ~GraphObject()
 	{
-		getGraphObjects().erase(this);
+		if (m_registry != nullptr)
+		{
+			GraphObject* moved = m_registry->remove(m_registryIndex);
+			if (moved != nullptr)
+				moved->m_registryIndex = m_registryIndex;
+		}
+	}
+
+	  // Takes the original's place in its registry, leaving the original in none, so this object is drawn instead
+	  // (ex: a copy made to move an object to new memory, after which the original is destroyed)
+	void takeRegistrationFrom(GraphObject& original)
+	{
+		m_registry = original.m_registry;
+		m_registryIndex = original.m_registryIndex;
+		if (m_registry != nullptr)
+			m_registry->replace(m_registryIndex, this);
+
+		original.m_registry = nullptr;
+		original.m_registryIndex = -1;
 	}
 
 	void setVisible(bool shouldIDisplay)
@@ -46,19 +66,19 @@ class GraphObject
 		m_brightness = brightness;
 	}
 
-	double getX() const
+	int getX() const
 	{
 		  // If already moved but not yet animated, use new location anyway.
 		return m_destX;
 	}
 
-	double getY() const
+	int getY() const
 	{
 		  // If already moved but not yet animated, use new location anyway.
 		return m_destY;
 	}
 
-	virtual void moveTo(double x, double y)
+	virtual void moveTo(int x, int y)
 	{
 		m_destX = x;
 		m_destY = y;
@@ -67,18 +87,41 @@ class GraphObject
 
 	virtual void moveAngle(int angle, int units = 1)
 	{
-		double newX;
-		double newY;
+		int newX;
+		int newY;
 		getPositionInThisDirection(angle, units, newX, newY);
 		moveTo(newX, newY);
 		increaseAnimationNumber();
 	}
 
-	virtual void getPositionInThisDirection(int angle, int units, double& newX, double& newY)
+	virtual void getPositionInThisDirection(int angle, int units, int& newX, int& newY)
+	{
+		int dx;
+		int dy;
+		getDirectionOffset(angle, dx, dy);
+		newX = getX() + units * dx;
+		newY = getY() + units * dy;
+	}
+
+	  // One square in each of the four grid directions, looked up instead of computed with cos/sin.
+	  // Any other angle (including none) does not move at all.
+	static void getDirectionOffset(int angle, int& dx, int& dy)
 	{
-		static const double PI = 4 * atan(1.0);
-		newX = (getX() + units * cos(angle*1.0 / 360 * 2 * PI));
-		newY = (getY() + units * sin(angle*1.0 / 360 * 2 * PI));
+		static const int OFFSETS[4][2] = {
+			{ 1, 0 },	// right
+			{ 0, 1 },	// up
+			{ -1, 0 },	// left
+			{ 0, -1 }	// down
+		};
+
+		if (angle < 0 || angle % 90 != 0)
+		{
+			dx = dy = 0;
+			return;
+		}
+
+		dx = OFFSETS[angle / 90 % 4][0];
+		dy = OFFSETS[angle / 90 % 4][1];
 	}
 
 	void moveForward(int units = 1)
@@ -132,6 +175,7 @@ class GraphObject
 		return m_animationNumber;
 	}
 
+	  // Positions are whole squares; they only become floating point here, for the renderer
 	void getAnimationLocation(double& x, double& y) const
 	{
 		x = m_x;
@@ -146,12 +190,6 @@ class GraphObject
 		//moveALittle(m_y, m_destY);
 	}
 
-	static std::set<GraphObject*>& getGraphObjects()
-	{
-		static std::set<GraphObject*> graphObjects;
-		return graphObjects;
-	}
-
 	void increaseAnimationNumber()
 	{
 		m_animationNumber++;
@@ -165,22 +203,34 @@ private:
 		return m_imageID;
 	}
 
+  protected:
+	  // A copy looks and stands exactly like the original, but is never drawn: it is in no registry
+	  // (ex: the actors of a forked, headless world)
+	GraphObject(const GraphObject& other)
+	 : m_imageID(other.m_imageID), m_visible(other.m_visible), m_x(other.m_x), m_y(other.m_y),
+	   m_destX(other.m_destX), m_destY(other.m_destY), m_brightness(other.m_brightness),
+	   m_animationNumber(other.m_animationNumber), m_direction(other.m_direction), m_size(other.m_size),
+	   m_registry(nullptr), m_registryIndex(-1)
+	{
+	}
+
   private:
-	  // Prevent copying or assigning GraphObjects
-	GraphObject(const GraphObject&);
+	  // Prevent assigning GraphObjects
 	GraphObject& operator=(const GraphObject&);
 
 	static const int NUM_DEPTHS = 4;
 	int		m_imageID;
 	bool	m_visible;
-	double	m_x;
-	double	m_y;
-	double	m_destX;
-	double	m_destY;
+	short	m_x;
+	short	m_y;
+	short	m_destX;
+	short	m_destY;
 	double	m_brightness;
 	int	m_animationNumber;
 	int	m_direction;
 	double	m_size;
+	GraphObjectRegistry* m_registry;
+	int		m_registryIndex;
 
 	void moveALittle(double& from, double& to)
 	{
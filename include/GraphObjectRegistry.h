@@ -0,0 +1,51 @@
+#ifndef GRAPHOBJECTREGISTRY_H_
+#define GRAPHOBJECTREGISTRY_H_
+
+#include <vector>
+
+class GraphObject;
+
+  // The GraphObjects of one world, kept in a plain array for the renderer to walk
+  // Each object remembers its index, so adding and removing are both constant time;
+  // removing moves the last object into the hole, so the order of the objects is not kept
+class GraphObjectRegistry
+{
+  public:
+	typedef std::vector<GraphObject*>::const_iterator const_iterator;
+
+	  // Returns the index the object was stored at
+	int add(GraphObject* object)
+	{
+		m_objects.push_back(object);
+		return static_cast<int>(m_objects.size()) - 1;
+	}
+
+	  // Returns the object that was moved into the index to fill the hole, or nullptr if the last object was removed
+	GraphObject* remove(int index)
+	{
+		GraphObject* moved = m_objects.back();
+		m_objects.pop_back();
+
+		if (index == static_cast<int>(m_objects.size()))
+			return nullptr;
+
+		m_objects[index] = moved;
+		return moved;
+	}
+
+	  // Puts another object in the index (ex: a copy of the object there, which replaces it)
+	void replace(int index, GraphObject* object)
+	{
+		m_objects[index] = object;
+	}
+
+	bool empty() const			{ return m_objects.empty(); }
+	int size() const			{ return static_cast<int>(m_objects.size()); }
+	const_iterator begin() const	{ return m_objects.begin(); }
+	const_iterator end() const		{ return m_objects.end(); }
+
+  private:
+	std::vector<GraphObject*> m_objects;
+};
+
+#endif // GRAPHOBJECTREGISTRY_H_
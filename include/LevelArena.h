@@ -0,0 +1,86 @@
+#ifndef LEVELARENA_H_
+#define LEVELARENA_H_
+
+#include <cstddef>
+#include <new>
+#include <utility>
+#include <vector>
+
+// Bump allocator for objects that all live exactly as long as one level
+// Objects are placed one after another in large chunks, and release() forgets all of them at once
+// The arena never runs destructors: whoever created an object must destroy it before the arena is released
+class LevelArena
+{
+public:
+    static const std::size_t CHUNK_SIZE = 16 * 1024;
+
+    LevelArena() : m_chunk(0), m_used(0) {}
+
+    ~LevelArena()
+    {
+        for (std::size_t i = 0; i != m_chunks.size(); i++)
+            ::operator delete(m_chunks[i]);
+    }
+
+    template <class T, class... Args>
+    T* create(Args&&... args)
+    {
+        static_assert(sizeof(T) <= CHUNK_SIZE, "object too large for a LevelArena chunk");
+        return new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+    }
+
+    // Returns true if p points into memory handed out by the arena since it was last released
+    bool owns(const void* p) const
+    {
+        const char* address = static_cast<const char*>(p);
+
+        for (std::size_t i = 0; i < m_chunks.size() && i <= m_chunk; i++)
+            if (address >= m_chunks[i] && address < m_chunks[i] + CHUNK_SIZE)
+                return true;
+
+        return false;
+    }
+
+    // Trades chunks, and so objects, with another arena (ex: to copy objects into a fresh arena and carry on with it)
+    void swap(LevelArena& other)
+    {
+        m_chunks.swap(other.m_chunks);
+        std::swap(m_chunk, other.m_chunk);
+        std::swap(m_used, other.m_used);
+    }
+
+    // Forgets every object in constant time, keeping the chunks for the next level
+    void release()
+    {
+        m_chunk = 0;
+        m_used = 0;
+    }
+private:
+    std::vector<char*> m_chunks;
+    std::size_t m_chunk;    // Index of the chunk being filled
+    std::size_t m_used;     // Bytes used in that chunk
+
+    void* allocate(std::size_t size, std::size_t alignment)
+    {
+        m_used = (m_used + alignment - 1) / alignment * alignment;
+
+        if (m_chunk < m_chunks.size() && m_used + size > CHUNK_SIZE)
+        {
+            m_chunk++;
+            m_used = 0;
+        }
+
+        if (m_chunk == m_chunks.size())
+            m_chunks.push_back(static_cast<char*>(::operator new(CHUNK_SIZE)));
+
+        void* memory = m_chunks[m_chunk] + m_used;
+        m_used += size;
+        return memory;
+    }
+
+    // Copying an arena would free the same chunks twice
+    LevelArena(const LevelArena&);
+    LevelArena& operator=(const LevelArena&);
+};
+
+#endif // LEVELARENA_H_
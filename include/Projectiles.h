@@ -0,0 +1,33 @@
+#ifndef PROJECTILES_H_
+#define PROJECTILES_H_
+
+#include <vector>
+
+// Peas in flight, kept in parallel arrays instead of as actors
+// Entry i of each array belongs to the same pea, and the peas stay in the order they were fired
+struct Projectiles
+{
+    std::vector<short> x;
+    std::vector<short> y;
+    std::vector<short> direction;
+
+    int size() const { return static_cast<int>(x.size()); }
+
+    void add(int startX, int startY, int dir)
+    {
+        x.push_back(startX);
+        y.push_back(startY);
+        direction.push_back(dir);
+    }
+
+    void resize(int n)
+    {
+        x.resize(n);
+        y.resize(n);
+        direction.resize(n);
+    }
+
+    void clear() { resize(0); }
+};
+
+#endif // PROJECTILES_H_
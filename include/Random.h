@@ -0,0 +1,116 @@
+#ifndef RANDOM_H_
+#define RANDOM_H_
+
+#include <cstdint>
+#include <cmath>
+
+// Small, fast pseudo-random number generator (xoshiro256**, by Blackman and Vigna)
+// Every StudentWorld owns one, so a game played from the same seed always plays out the same way
+// split() hands out independent streams (each 2^128 numbers apart) for anything that needs its own
+class Random
+{
+public:
+    explicit Random(std::uint64_t seed = 0) { reseed(seed); }
+
+    void reseed(std::uint64_t seed)
+    {
+        // Spread the seed over the whole state with splitmix64, which never leaves the state all zero
+        for (int i = 0; i < 4; i++)
+        {
+            seed += 0x9e3779b97f4a7c15ULL;
+            std::uint64_t z = seed;
+            z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+            z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+            m_state[i] = z ^ (z >> 31);
+        }
+    }
+
+    std::uint64_t next()
+    {
+        std::uint64_t result = rotl(m_state[1] * 5, 7) * 9;
+        std::uint64_t t = m_state[1] << 17;
+
+        m_state[2] ^= m_state[0];
+        m_state[3] ^= m_state[1];
+        m_state[1] ^= m_state[2];
+        m_state[0] ^= m_state[3];
+        m_state[2] ^= t;
+        m_state[3] = rotl(m_state[3], 45);
+
+        return result;
+    }
+
+    // Uniformly distributed int from min to max, inclusive
+    // Scales a 32-bit number into the range with one multiply, and only rejects the few numbers that would bias it
+    int nextInt(int min, int max)
+    {
+        if (max < min)
+        {
+            int temp = min;
+            min = max;
+            max = temp;
+        }
+
+        std::uint32_t range = static_cast<std::uint32_t>(static_cast<std::int64_t>(max) - min + 1);
+        std::uint64_t scaled = (next() >> 32) * range;
+
+        if (static_cast<std::uint32_t>(scaled) < range)
+        {
+            std::uint32_t threshold = (0u - range) % range;
+
+            while (static_cast<std::uint32_t>(scaled) < threshold)
+                scaled = (next() >> 32) * range;
+        }
+
+        return static_cast<int>(min + static_cast<std::int64_t>(scaled >> 32));
+    }
+
+    // Number of independent trials up to and including the first success, when each succeeds with a chance of 1 in n
+    // (ex: how many nextInt(1, n) == 1 rolls it takes until one is true)
+    int trialsUntilSuccess(int n)
+    {
+        if (n <= 1)
+            return 1;
+
+        // Invert the geometric distribution with a uniform number in (0, 1]
+        double uniform = ((next() >> 11) + 1) * (1.0 / 9007199254740992.0);
+        return 1 + static_cast<int>(std::log(uniform) / std::log1p(-1.0 / n));
+    }
+
+    // Word i (0 to 3) of the generator's state
+    std::uint64_t getState(int i) const { return m_state[i]; }
+    void setState(int i, std::uint64_t word) { m_state[i] = word; }
+
+    // Returns a generator for an independent stream, and moves this one past it
+    Random split()
+    {
+        Random stream = *this;
+        jump();
+        return stream;
+    }
+private:
+    std::uint64_t m_state[4];
+
+    static std::uint64_t rotl(std::uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+
+    // Same as 2^128 calls to next()
+    void jump()
+    {
+        static const std::uint64_t JUMP[] = { 0x180ec6d33cfd0abaULL, 0xd5a61266f0c9392cULL, 0xa9582618e03fc9aaULL, 0x39abdc4529b1661cULL };
+        std::uint64_t state[4] = { 0, 0, 0, 0 };
+
+        for (int i = 0; i < 4; i++)
+            for (int b = 0; b < 64; b++)
+            {
+                if (JUMP[i] & (std::uint64_t(1) << b))
+                    for (int j = 0; j < 4; j++)
+                        state[j] ^= m_state[j];
+                next();
+            }
+
+        for (int j = 0; j < 4; j++)
+            m_state[j] = state[j];
+    }
+};
+
+#endif // RANDOM_H_
@@ -0,0 +1,73 @@
+#ifndef SNAPSHOT_H_
+#define SNAPSHOT_H_
+
+#include <cstddef>
+#include <cstdint>
+
+// Writes the fixed-size little-endian fields of a snapshot into a caller's buffer (see StudentWorld::saveSnapshot)
+// Writes past the end of the buffer are only counted, so size() is always the size the whole snapshot needs
+class SnapshotWriter
+{
+public:
+    SnapshotWriter(unsigned char* buffer, std::size_t capacity) : m_buffer(buffer), m_capacity(capacity), m_size(0) {}
+
+    void putU8(unsigned value)              { put(value, 1); }
+    void putI16(int value)                  { put(static_cast<std::uint16_t>(value), 2); }
+    void putI32(int value)                  { put(static_cast<std::uint32_t>(value), 4); }
+    void putU32(std::uint32_t value)        { put(value, 4); }
+    void putU64(std::uint64_t value)        { put(value, 8); }
+
+    std::size_t size() const { return m_size; }
+private:
+    unsigned char* m_buffer;
+    std::size_t m_capacity;
+    std::size_t m_size;
+
+    void put(std::uint64_t value, int bytes)
+    {
+        for (int i = 0; i < bytes; i++, m_size++)
+            if (m_size < m_capacity)
+                m_buffer[m_size] = static_cast<unsigned char>(value >> (8 * i));
+    }
+};
+
+// Reads the fields written by a SnapshotWriter back, in the same order
+// Reading past the end of the data gives zeros and marks the reader as failed
+class SnapshotReader
+{
+public:
+    SnapshotReader(const unsigned char* data, std::size_t size) : m_data(data), m_size(size), m_position(0), m_failed(false) {}
+
+    unsigned getU8()                { return static_cast<unsigned>(get(1)); }
+    int getI16()                    { return static_cast<std::int16_t>(get(2)); }
+    int getI32()                    { return static_cast<std::int32_t>(get(4)); }
+    std::uint32_t getU32()          { return static_cast<std::uint32_t>(get(4)); }
+    std::uint64_t getU64()          { return get(8); }
+
+    bool failed() const             { return m_failed; }
+    bool atEnd() const              { return m_position == m_size; }
+private:
+    const unsigned char* m_data;
+    std::size_t m_size;
+    std::size_t m_position;
+    bool m_failed;
+
+    std::uint64_t get(int bytes)
+    {
+        if (m_size - m_position < static_cast<std::size_t>(bytes))
+        {
+            m_failed = true;
+            m_position = m_size;
+            return 0;
+        }
+
+        std::uint64_t value = 0;
+
+        for (int i = 0; i < bytes; i++)
+            value |= static_cast<std::uint64_t>(m_data[m_position++]) << (8 * i);
+
+        return value;
+    }
+};
+
+#endif // SNAPSHOT_H_
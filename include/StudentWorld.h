@@ -3,15 +3,28 @@
 
 #include "GameWorld.h"
 #include "Level.h"
+#include "Actor.h"
+#include "Bitboard.h"
+#include "TimingWheel.h"
+#include "Random.h"
+#include "Projectiles.h"
+#include "ActorPool.h"
+#include "LevelArena.h"
 #include <string>
+#include <memory>
+#include <cstddef>
 
 // Students:  Add code to this file, StudentWorld.cpp, Actor.h, and Actor.cpp
 
 const int INITIAL_BONUS = 1000;
 
+// Walls never change, so they are part of the static terrain instead of being actors
+const unsigned WALL_ATTRIBUTES = Actor::BLOCKS_MOVEMENT | Actor::BLOCKS_ROBOT_SIGHT | Actor::BLOCKS_PEA_MOVEMENT | Actor::OCCUPIES_SQUARE;
+
 #include <vector>
 class Actor;
 class Avatar;
+class SnapshotReader;
 
 class StudentWorld : public GameWorld
 {
@@ -21,32 +34,273 @@ public:
     virtual int init();
     virtual int move();
     virtual void cleanUp();
+    virtual int getTerrainImageAt(int x, int y) const;
+    virtual void setRandomSeed(unsigned long long seed) { m_random.reseed(seed); }
+    
+    // The actors' random numbers all come from the world's own generator
+    int randInt(int min, int max) { return m_random.nextInt(min, max); }
+    int randTrialsUntilSuccess(int n) { return m_random.trialsUntilSuccess(n); }
     
     bool hasCollectedAllCrystals() const;
-    Actor* blocksMovementAt(double x, double y);
-    Actor* canBePushedAt(double x, double y);
-    Actor* stolenByThiefBotsAt(double x, double y);
-    Actor* allowsMarbleMovementAt(double x, double y);
-    Actor* countedByFactoriesAt(double x, double y);
-    Actor* canBeSwallowedAt(double x, double y);
-    Actor* canBeAttackedAt(double x, double y);
-    Actor* blocksPeaMovementAt(double x, double y);
-    Actor* anyActorAt(double x, double y);
-    bool blocksRobotSightBetween(double robotX, double robotY, double playerX, double playerY);
-    
-    void addActor(Actor* actor) { m_actors.push_back(actor); }
-    Avatar* getPlayer() const { return m_avatar; }
+    
+    // Returns the handle of an actor at (x, y) with any of the given attributes, or a null handle if there is none
+    template <unsigned Attributes>
+    ActorHandle actorAt(int x, int y);
+    
+    // Returns the actor a handle refers to, or nullptr if the handle is null or the actor has been freed
+    Actor* resolve(ActorHandle handle) const;
+    
+    // Returns true if any actor at (x, y) has any of the given attributes, using only bit tests
+    template <unsigned Attributes>
+    bool hasAttributeAt(int x, int y) const;
+    
+    // Returns every attribute of the actors at (x, y) combined, which is 0 for an empty square
+    unsigned attributesAt(int x, int y) const;
+    
+    // Peas are not actors: they are kept in compact arrays and all move together after every actor has acted
+    void firePea(int x, int y, int direction);
+    virtual int getNumProjectiles() const { return m_peas.size(); }
+    virtual void getProjectile(int i, int& imageID, int& x, int& y, int& direction) const;
+    
+    // Returns true if nothing blocks a robot's sight between (x, y) and the player, who must be in the same row or column
+    bool canSeePlayerFrom(int x, int y);
+    
+    // ThiefBots come and go all level long, so they are recycled through the world's pools instead of the heap
+    // Any ThiefBot or MeanThiefBot given to addActor must come from these
+    ThiefBot* newThiefBot(int x, int y);
+    MeanThiefBot* newMeanThiefBot(int x, int y);
+    
+    // Actors stay in the memory they were made in, unless the world is set to SPATIAL_ORDER: then every
+    // SPATIAL_SORT_INTERVAL ticks they are moved in memory along a Z-order curve over the board, so actors close
+    // together on the board (ex: a ThiefBot and the goodie it stands on) are close together in memory too, and the
+    // end-of-tick pass over every actor walks them in that order. Handles and the order actors act in are unchanged,
+    // so the game plays out exactly the same either way
+    enum ActorOrder { INSERTION_ORDER, SPATIAL_ORDER };
+    void setActorOrder(ActorOrder order);
+    static const int SPATIAL_SORT_INTERVAL = 64;
+    
+    // Goodies a dying ThiefBot puts back come from the level's arena, as init's do (nullptr if the type is not a goodie)
+    Actor* newGoodie(Actor::Type type, int x, int y);
+    
+    // What the level in play has allocated so far; cleanUp resets the counts, and leaves reporting them to the caller
+    // Peas are never actors, so firing them only appends to the pea arrays, which keep their memory between levels
+    struct AllocationCounts
+    {
+        int thiefBotsMade;
+        int thiefBotsFromHeap;      // ThiefBots that needed new memory, rather than reusing a dead one's
+        int meanThiefBotsMade;
+        int meanThiefBotsFromHeap;
+        int peasFired;
+    };
+    AllocationCounts getAllocationCounts() const;
+    
+    void addActor(Actor* actor);
+    void takeOffBoard(Actor* actor);
+    void updateActorCell(Actor* actor, int oldX, int oldY);
+    Avatar* getPlayer() const { return static_cast<Avatar*>(resolve(m_player)); }
     void setCompletedLevel(bool status) { m_completedLevel = status; }
+    void revealExit();
+    
+    // Ticks are numbered from 1 at the start of each level
+    int getTick() const { return m_tick; }
+    void scheduleAction(Actor* actor, int tick);
+    
+    // Actors call this whenever any state of theirs in the state hash changes (see getStateHash)
+    void actorChanged(const Actor* actor);
+    
+    // 64-bit fingerprint of the game state: the type, square, direction, health and status of every actor, the tick
+    // each robot or factory acts next, each ThiefBot's goodie, distances and steal countdown, whether the exit is
+    // revealed, the peas in flight, the player's ammo and crystals, the bonus, the crystals left and the random number
+    // generator
+    // Kept up to date as the state changes, so asking for it is constant time
+    std::uint64_t getStateHash() const;
+    
+    // Returns an independent copy of the world, for trying moves out (ex: AI lookahead); the caller deletes it
+    // The copy is headless (see GameWorld::pressKey). It shares the parsed level with this world and copies the rest
+    // in bulk, so a fork costs microseconds instead of an init
+    StudentWorld* fork() const;
+    
+    // Writes the level in play (every actor, the peas, the schedules, the player's progress and the random number
+    // generator) into the buffer as a compact versioned blob, between ticks, without allocating anything
+    // Returns the size of the whole snapshot; if that is more than the capacity, only its start was written
+    std::size_t saveSnapshot(unsigned char* buffer, std::size_t capacity) const;
+    
+    // Replaces the level in play with a saved one, which then plays on exactly as the saved world would have
+    // Returns false, leaving the world empty until the next init, if the data is not a snapshot of this version
+    bool loadSnapshot(const unsigned char* data, std::size_t size);
+    static const int SNAPSHOT_VERSION = 2;
     
     virtual ~StudentWorld();
 private:
+    // fork() copies the world with this; every actor is copied into the same slot, so handles carry over unchanged
+    StudentWorld(const StudentWorld& parent);
+    StudentWorld& operator=(const StudentWorld&);
+    Actor* copyActor(const Actor* actor);
+    template <class T>
+    Actor* copyInArena(const Actor* actor) { return m_levelArena.create<T>(*static_cast<const T*>(actor)); }
+    void copyActorList(const std::vector<Actor*>& from, std::vector<Actor*>& to) const;
+    
+    // loadSnapshot makes each actor as init or a factory would have, and then has it read the state it saved
+    Actor* newActor(Actor::Type type, int x, int y);
+    bool loadLevelState(SnapshotReader& in);
+    
     std::vector<Actor*> m_actors;
-    Avatar* m_avatar;
+    std::vector<Actor*> m_spawned;
+    ActorHandle m_player;
     int m_bonus;
     int m_crystals;
     bool m_completedLevel;
+    bool m_revealExitPending;
     void updateDisplayText();
-    Actor* blocksRobotSightAt(double x, double y);
+    void mergeSpawnedActors();
+    void joinGroup(Actor* actor);
+    
+    // The actors of each concrete type, in the order they were added, so a tick can dispatch one type at a time
+    std::vector<Actor*> m_groups[Actor::NUM_TYPES];
+    int tickStatus();
+    int tickGroup(Actor::Type type);
+    static void removeDeadActors(std::vector<Actor*>& group);
+    
+    // Every actor in the world (the player included) has a slot, found through its handle
+    // A freed slot's generation moves on, so handles to the actor it held stop resolving
+    struct Slot
+    {
+        Actor* actor;
+        std::uint32_t generation;
+        std::uint64_t stateKey;     // What the actor adds to m_stateHash
+    };
+    std::vector<Slot> m_slots;
+    std::vector<std::uint32_t> m_freeSlots;
+    void assignHandle(Actor* actor);
+    void releaseHandle(Actor* actor);
+    
+    // Frees an actor, returning pooled types to their pool (see getAllocationCounts)
+    // Actors from the level's arena only have their destructors run, since clearActors releases the arena as a whole
+    LevelArena m_levelArena;
+    ActorPool<ThiefBot> m_thiefBotPool;
+    ActorPool<MeanThiefBot> m_meanThiefBotPool;
+    int m_peasFired;
+    void destroyActor(Actor* actor);
+    void resetAllocationCounts();
+    
+    // Moving actors in memory (see setActorOrder): each actor is copied to its new place, every list is pointed at
+    // the copies through the slots, and only then are the originals destroyed
+    // Arena actors are copied into the spare arena, which then trades places with the level's arena
+    ActorOrder m_actorOrder;
+    LevelArena m_spareArena;
+    std::vector<std::uint64_t> m_spatialKeys;
+    std::vector<std::uint32_t> m_spatialSlots;     // The slots of the actors being moved, in Z order
+    std::vector<void*> m_poolBlocks;
+    std::vector<Actor*> m_movedFrom;
+    void sortActorsSpatially();
+    template <class T>
+    void sortPooledActors(Actor::Type type);
+    void moveActor(Actor* from, Actor* to);
+    void finishMoves();
+    
+    // Robots and factories only act on some ticks, so each of their types has a timing wheel of the actors due on each tick
+    // The wheels hold handles, so an actor that dies while scheduled simply fails to resolve when its tick comes
+    int m_tick;
+    TimingWheel<ActorHandle> m_wheels[Actor::NUM_TYPES];
+    std::vector<ActorHandle> m_due;
+    void scheduleFirstAction(Actor* actor);
+    template <class T>
+    int tickScheduled(Actor::Type type);
+    
+    Random m_random;
+    
+    // XOR of the keys of every actor and pea in the world (see getStateHash)
+    std::uint64_t m_stateHash;
+    static std::uint64_t actorKey(const Actor* actor);
+    static std::uint64_t peaKey(int x, int y, int direction);
+    
+    // Static terrain layer built from the level data file, checked before any actor
+    enum Terrain : unsigned char { OPEN, WALL };
+    Terrain m_terrain[VIEW_HEIGHT][VIEW_WIDTH];
+    static unsigned terrainAttributes(Terrain terrain) { return terrain == WALL ? WALL_ATTRIBUTES : 0; }
+    
+    // The last level file parsed: its terrain layer with the attributes the terrain gives each square, and the actors
+    // to create in the order init creates them, so playing the level again after a lost life needs no file I/O
+    // A template never changes once built, so forked worlds share their parent's (nullptr until a level is parsed)
+    struct LevelTemplate
+    {
+        struct Spawn
+        {
+            Level::MazeEntry item;
+            unsigned char x;
+            unsigned char y;
+        };
+        
+        int level;
+        Terrain terrain[VIEW_HEIGHT][VIEW_WIDTH];
+        unsigned squareAttributes[VIEW_HEIGHT][VIEW_WIDTH];
+        Bitboard attributeBoards[Actor::NUM_ATTRIBUTES];
+        std::vector<Spawn> spawns;
+    };
+    std::shared_ptr<const LevelTemplate> m_levelTemplate;
+    int loadLevelTemplate();
+    int prepareLevel();
+    
+    // Uniform grid of the actors occupying each square, so queries only look at a single square
+    std::vector<Actor*> m_grid[VIEW_HEIGHT][VIEW_WIDTH];
+    const std::vector<Actor*>& occupantsAt(int x, int y) const;
+    void addToCell(Actor* actor, int x, int y);
+    void removeFromCell(Actor* actor, int x, int y);
+    void clearActors();
+    
+    // Peas in flight, the number of peas on each square (a pea occupies its square; any number of peas can share one),
+    // and the targets hit during a tick
+    Projectiles m_peas;
+    int m_peaCounts[VIEW_HEIGHT][VIEW_WIDTH];
+    std::vector<ActorHandle> m_peaHits;
+    int movePeas();
+    bool peaStopsAt(int x, int y, ActorHandle& target);
+    void addPeaTo(int x, int y);
+    void removePeaFrom(int x, int y);
+    
+    // The combined attributes of each square, and one bitboard per attribute built from them
+    unsigned m_squareAttributes[VIEW_HEIGHT][VIEW_WIDTH];
+    Bitboard m_attributeBoards[Actor::NUM_ATTRIBUTES];
+    void refreshSquare(int x, int y);
+    
+    // The squares of the player's row and column with a clear line of sight to the player, shared by every robot
+    // Rebuilt only when asked for after the player or a sight blocker has moved
+    Bitboard m_playerSight;
+    bool m_playerSightValid;
+    void computePlayerSight();
+    void updateFactoryCensus(int x, int y, int delta);
+    static bool isOnBoard(int x, int y) { return x >= 0 && x < VIEW_WIDTH && y >= 0 && y < VIEW_HEIGHT; }
 };
 
+template <unsigned Attributes>
+ActorHandle StudentWorld::actorAt(int x, int y)
+{
+    // Most squares have none of the attributes asked for, so skip their occupants entirely
+    if ((attributesAt(x, y) & Attributes) == 0)
+        return ActorHandle();
+    
+    const std::vector<Actor*>& cell = occupantsAt(x, y);
+    
+    for (int i = 0; i != cell.size(); i++)
+        if (cell[i]->hasAttribute(Attributes))
+            return cell[i]->getHandle();
+    
+    return ActorHandle();
+}
+
+template <unsigned Attributes>
+bool StudentWorld::hasAttributeAt(int x, int y) const
+{
+    if ( ! isOnBoard(x, y))
+        return false;
+    
+    int square = Bitboard::square(x, y);
+    
+    for (int i = 0; i < Actor::NUM_ATTRIBUTES; i++)
+        if ((Attributes & (1u << i)) != 0 && m_attributeBoards[i].test(square))
+            return true;
+    
+    return false;
+}
+
 #endif // STUDENTWORLD_H_
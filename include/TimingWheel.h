@@ -0,0 +1,54 @@
+#ifndef TIMINGWHEEL_H_
+#define TIMINGWHEEL_H_
+
+#include <vector>
+
+// Hashed timing wheel: an item scheduled for tick t waits in slot t % NUM_SLOTS until that tick comes around
+// Items due on the same tick are handed out in the order they were scheduled
+// Items scheduled more than NUM_SLOTS ticks ahead simply stay in their slot for the extra laps
+template <class T>
+class TimingWheel
+{
+public:
+    static const int NUM_SLOTS = 64;
+
+    struct Entry
+    {
+        int tick;
+        T item;
+    };
+
+    void schedule(T item, int tick)
+    {
+        Entry entry = { tick, item };
+        m_slots[tick % NUM_SLOTS].push_back(entry);
+    }
+
+    // Appends the items due on the given tick to "due" and removes them from the wheel
+    void takeDue(int tick, std::vector<T>& due)
+    {
+        std::vector<Entry>& slot = m_slots[tick % NUM_SLOTS];
+        int waiting = 0;
+
+        for (int i = 0; i != slot.size(); i++)
+            if (slot[i].tick == tick)
+                due.push_back(slot[i].item);
+            else
+                slot[waiting++] = slot[i];
+
+        slot.resize(waiting);
+    }
+
+    void clear()
+    {
+        for (int s = 0; s != NUM_SLOTS; s++)
+            m_slots[s].clear();
+    }
+
+    // The items waiting in slot s, in the order they were scheduled (ex: for saving the wheel)
+    const std::vector<Entry>& entriesIn(int s) const { return m_slots[s]; }
+private:
+    std::vector<Entry> m_slots[NUM_SLOTS];
+};
+
+#endif // TIMINGWHEEL_H_
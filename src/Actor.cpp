@@ -1,51 +1,64 @@
 #include "Actor.h"
 #include "StudentWorld.h"
+#include "Snapshot.h"
 
 // Students:  Add code to this file, Actor.h, StudentWorld.h, and StudentWorld.cpp
 
 // Actor
-Actor::Actor(StudentWorld* world, int imageID, double startX, double startY, int dir)
-: GraphObject(imageID, startX, startY, dir), m_alive(ALIVE), m_world(world) {}
+Actor::Actor(StudentWorld* world, Type type, int imageID, int startX, int startY, int dir, unsigned attributes)
+: GraphObject(world->getGraphObjects(), imageID, startX, startY, dir), m_attributes(attributes | OCCUPIES_SQUARE), m_type(type), m_alive(ALIVE), m_world(world) {}
 
-void Actor::adjustPosFromDir(int dir, double& x, double& y) const
+void Actor::setStatus(bool status)
+{
+    m_alive = status;
+    getWorld()->actorChanged(this);
+}
+
+void Actor::setDirection(int dir)
+{
+    GraphObject::setDirection(dir);
+    getWorld()->actorChanged(this);
+}
+
+void Actor::adjustPosFromDir(int dir, int& x, int& y) const
 {
     // Since many classes need to check if there is something adjacent to it, this function adjusts x and y coordinates
     // according to the specified direction to solve this frequently occurring problem
-    switch (dir)
-    {
-        case right:
-            x++;
-            break;
-        case left:
-            x--;
-            break;
-        case up:
-            y++;
-            break;
-        case down:
-            y--;
-            break;
-    }
+    int dx;
+    int dy;
+    getDirectionOffset(dir, dx, dy);
+    x += dx;
+    y += dy;
 }
 
 void Actor::move(int dir)
 {
     // The actor moves to the adjusted x and y coordinates according to the specified direction
-    double x = getX();
-    double y = getY();
+    int x = getX();
+    int y = getY();
     adjustPosFromDir(dir, x, y);
     moveTo(x, y);
 }
 
+void Actor::moveTo(int x, int y)
+{
+    // Every change of position goes through here, so the world's grid always knows which square the actor is on
+    int oldX = getX();
+    int oldY = getY();
+    GraphObject::moveTo(x, y);
+    getWorld()->updateActorCell(this, oldX, oldY);
+    getWorld()->actorChanged(this);
+}
+
 bool Actor::attemptToMove(int dir)
 {
     // If the actor can move in the specified direction, it moves and this returns true
     // Otherwise, the actor does not move and this returns false
-    double x = getX();
-    double y = getY();
+    int x = getX();
+    int y = getY();
     adjustPosFromDir(dir, x, y);
     
-    if ( ! getWorld()->getPlayer()->isAt(x, y) && getWorld()->blocksMovementAt(x, y) == nullptr)
+    if ( ! getWorld()->getPlayer()->isAt(x, y) && ! getWorld()->hasAttributeAt<BLOCKS_MOVEMENT>(x, y))
     {
         move(dir);
         return true;
@@ -54,17 +67,40 @@ bool Actor::attemptToMove(int dir)
     return false;
 }
 
+void Actor::saveState(SnapshotWriter& out) const
+{
+    // Only live actors are saved, so there is no status to write
+    out.putI16(getDirection());
+    out.putU8(isVisible());
+}
+
+void Actor::loadState(SnapshotReader& in)
+{
+    // Actors without a direction keep GraphObject::none, which setDirection would turn into an angle
+    int dir = in.getI16();
+    if (dir != getDirection())
+        setDirection(dir);
+    
+    setVisible(in.getU8() != 0);
+}
+
 // CanBeAttacked
-CanBeAttacked::CanBeAttacked(StudentWorld* world, int health, int imageID, double startX, double startY, int dir)
-: Actor(world, imageID, startX, startY, dir), m_health(health) {}
+CanBeAttacked::CanBeAttacked(StudentWorld* world, Type type, int health, int imageID, int startX, int startY, int dir, unsigned attributes)
+: Actor(world, type, imageID, startX, startY, dir, ATTRIBUTES | attributes), m_health(health) {}
+
+void CanBeAttacked::setHealth(int amount)
+{
+    m_health = amount;
+    getWorld()->actorChanged(this);
+}
 
 void CanBeAttacked::firePea() const
 {
     // Create a pea at the adjusted x and y coordinates according to the specified direction
-    double peaX = getX();
-    double peaY = getY();
+    int peaX = getX();
+    int peaY = getY();
     adjustPosFromDir(getDirection(), peaX, peaY);
-    getWorld()->addActor(new Pea(getWorld(), peaX, peaY, getDirection()));
+    getWorld()->firePea(peaX, peaY, getDirection());
 }
 
 void CanBeAttacked::damage()
@@ -74,9 +110,21 @@ void CanBeAttacked::damage()
     damageEffect();
 }
 
+void CanBeAttacked::saveState(SnapshotWriter& out) const
+{
+    Actor::saveState(out);
+    out.putI16(m_health);
+}
+
+void CanBeAttacked::loadState(SnapshotReader& in)
+{
+    Actor::loadState(in);
+    m_health = in.getI16();
+}
+
 // Avatar
-Avatar::Avatar(StudentWorld* world, double startX, double startY)
-: CanBeAttacked(world, PLAYER_INITIAL_HEALTH, IID_PLAYER, startX, startY), m_ammo(INITIAL_AMMO), m_crystals(0) {}
+Avatar::Avatar(StudentWorld* world, int startX, int startY)
+: CanBeAttacked(world, AVATAR, PLAYER_INITIAL_HEALTH, IID_PLAYER, startX, startY), m_ammo(INITIAL_AMMO), m_crystals(0) {}
 
 void Avatar::doSomething()
 {
@@ -119,10 +167,10 @@ void Avatar::doSomething()
         }
         
         // Attempt to push a marble
-        double x = getX();
-        double y = getY();
+        int x = getX();
+        int y = getY();
         adjustPosFromDir(getDirection(), x, y);
-        Actor* canBePushedAt = getWorld()->canBePushedAt(x, y);
+        Actor* canBePushedAt = getWorld()->resolve(getWorld()->actorAt<CAN_BE_PUSHED>(x, y));
         
         if (canBePushedAt != nullptr)
             canBePushedAt->push();
@@ -143,9 +191,23 @@ void Avatar::damageEffect()
     }
 }
 
+void Avatar::saveState(SnapshotWriter& out) const
+{
+    CanBeAttacked::saveState(out);
+    out.putI32(m_ammo);
+    out.putI32(m_crystals);
+}
+
+void Avatar::loadState(SnapshotReader& in)
+{
+    CanBeAttacked::loadState(in);
+    m_ammo = in.getI32();
+    m_crystals = in.getI32();
+}
+
 // Robot
-Robot::Robot(StudentWorld* world, int health, int imageID, double startX, double startY, int dir)
-: CanBeAttacked(world, health, imageID, startX, startY, dir), m_currentTick(1)
+Robot::Robot(StudentWorld* world, Type type, int health, int imageID, int startX, int startY, int dir, unsigned attributes)
+: CanBeAttacked(world, type, health, imageID, startX, startY, dir, attributes), m_nextTick(0)
 {
     m_ticks = (28 - getWorld()->getLevel()) / 4;
     
@@ -153,20 +215,20 @@ Robot::Robot(StudentWorld* world, int health, int imageID, double startX, double
     if (m_ticks < 3)
         m_ticks = 3;
     
-    // m_currentTick refers to the tick about to start (ex: a value of 3 means the robot is going to start its 3rd tick)
+    // m_nextTick is the world tick on which the robot acts next (set when the robot joins the world)
 }
 
-bool Robot::canDoSomething()
+void Robot::scheduleActionAt(int tick)
 {
-    // Determine if the robot must "rest" or be active during this tick
-    if (m_currentTick != m_ticks)
-    {
-        m_currentTick++;
-        return false;
-    }
-    
-    m_currentTick = 1;
-    return true;
+    m_nextTick = tick;
+    getWorld()->scheduleAction(this, tick);
+    getWorld()->actorChanged(this);
+}
+
+void Robot::rest()
+{
+    // The robot is active during this tick and rests for the next m_ticks - 1 ticks
+    scheduleActionAt(getWorld()->getTick() + m_ticks);
 }
 
 bool Robot::canFirePea() const
@@ -200,12 +262,25 @@ bool Robot::canFirePea() const
     }
     
     // If there are no objects blocking the robot's line of sight, return true, returning false otherwise
-    return ! getWorld()->blocksRobotSightBetween(getX(), getY(), player->getX(), player->getY());
+    return getWorld()->canSeePlayerFrom(getX(), getY());
+}
+
+void Robot::saveState(SnapshotWriter& out) const
+{
+    // The rest between actions comes from the level, but the tick of the next action is part of the robot's state
+    CanBeAttacked::saveState(out);
+    out.putI32(m_nextTick);
+}
+
+void Robot::loadState(SnapshotReader& in)
+{
+    CanBeAttacked::loadState(in);
+    m_nextTick = in.getI32();
 }
 
 // RageBot
-RageBot::RageBot(StudentWorld* world, double startX, double startY, int dir)
-: Robot(world, RAGEBOT_INITIAL_HEALTH, IID_RAGEBOT, startX, startY, dir) {}
+RageBot::RageBot(StudentWorld* world, int startX, int startY, int dir)
+: Robot(world, RAGEBOT, RAGEBOT_INITIAL_HEALTH, IID_RAGEBOT, startX, startY, dir) {}
 
 void RageBot::doSomething()
 {
@@ -213,8 +288,7 @@ void RageBot::doSomething()
     if ( ! isAlive())
         return;
     
-    if ( ! canDoSomething())
-        return;
+    rest();
 
     if (canFirePea())
     {
@@ -256,8 +330,8 @@ void RageBot::damageEffect()
 }
 
 // ThiefBot
-ThiefBot::ThiefBot(StudentWorld* world, int health, int imageID, double startX, double startY)
-: Robot(world, health, imageID, startX, startY), m_distanceBeforeTurning(randInt(1, 6)), m_distanceTraveled(0), m_hasPickedUpGoodie(false), m_goodie(nullptr) {}
+ThiefBot::ThiefBot(StudentWorld* world, Type type, int health, int imageID, int startX, int startY)
+: Robot(world, type, health, imageID, startX, startY, right, ATTRIBUTES), m_distanceBeforeTurning(world->randInt(1, 6)), m_distanceTraveled(0), m_rollsBeforeSteal(world->randTrialsUntilSuccess(THIEFBOT_STEAL_ODDS)), m_carriedGoodie(NUM_TYPES) {}
 
 void ThiefBot::doSomething()
 {
@@ -266,8 +340,7 @@ void ThiefBot::doSomething()
     if ( ! isAlive())
         return;
     
-    if ( ! canDoSomething())
-        return;
+    rest();
 
     if (ableToFirePeas() && canFirePea())
     {
@@ -276,30 +349,37 @@ void ThiefBot::doSomething()
         return;
     }
     
-    Actor* stolenByThiefBotsAt = getWorld()->stolenByThiefBotsAt(getX(), getY());
+    Actor* stolenByThiefBotsAt = getWorld()->resolve(getWorld()->actorAt<STOLEN_BY_THIEFBOTS>(getX(), getY()));
     
-    if (stolenByThiefBotsAt != nullptr && ! m_hasPickedUpGoodie)
+    if (stolenByThiefBotsAt != nullptr && m_carriedGoodie == NUM_TYPES)
     {
-        if (randInt(1, 10) == 1)
+        // Each attempt succeeds with a chance of 1 in THIEFBOT_STEAL_ODDS, so the number of attempts up to the
+        // successful one is drawn once instead of rolling on every attempt
+        if (--m_rollsBeforeSteal == 0)
         {
-            // Make the goodie essentially invisible to the player (the player cannot see or collect it)
-            m_hasPickedUpGoodie = true;
-            m_goodie = stolenByThiefBotsAt;
-            m_goodie->setVisible(false);
-            m_goodie->setCanCollect(false);
+            m_rollsBeforeSteal = getWorld()->randTrialsUntilSuccess(THIEFBOT_STEAL_ODDS);
+            
+            // The goodie leaves the board entirely; the ThiefBot only remembers what kind it was
+            m_carriedGoodie = stolenByThiefBotsAt->getType();
+            getWorld()->actorChanged(this);
+            getWorld()->takeOffBoard(stolenByThiefBotsAt);
             getWorld()->playSound(SOUND_ROBOT_MUNCH);
             return;
         }
+        
+        getWorld()->actorChanged(this);
     }
     
     if ((m_distanceTraveled != m_distanceBeforeTurning) && attemptToMove(getDirection()))
     {
         m_distanceTraveled++;
+        getWorld()->actorChanged(this);
         return;
     }
     
-    m_distanceBeforeTurning = randInt(1, 6);
+    m_distanceBeforeTurning = getWorld()->randInt(1, 6);
     m_distanceTraveled = 0;
+    getWorld()->actorChanged(this);
 
     // Keep track of what directions have an obstacle blocking the way
     bool usedDir[4] = { false, false, false, false };
@@ -307,7 +387,7 @@ void ThiefBot::doSomething()
     
     for ( ; ; )
     {
-        int randIndex = randInt(0, 3);
+        int randIndex = getWorld()->randInt(0, 3);
         int randDir = 0;
         
         if (usedDir[randIndex] == true)
@@ -334,6 +414,7 @@ void ThiefBot::doSomething()
             // Successfully moved, so return
             setDirection(randDir);
             m_distanceTraveled++;
+            getWorld()->actorChanged(this);
             return;
         }
         
@@ -355,14 +436,9 @@ void ThiefBot::damageEffect()
         getWorld()->playSound(SOUND_ROBOT_IMPACT);
     else
     {
-        if (m_goodie != nullptr)
-        {
-            // The ThiefBot that held a goodie has died, so make the goodie visible and able to be collected again
-            m_goodie->moveTo(getX(), getY());
-            m_goodie->setVisible(true);
-            m_goodie->setCanCollect(true);
-            m_goodie = nullptr;
-        }
+        // The ThiefBot that held a goodie has died, so put the goodie back where the player can collect it
+        if (m_carriedGoodie != NUM_TYPES)
+            dropGoodie();
         
         setStatus(DEAD);
         getWorld()->playSound(SOUND_ROBOT_DIE);
@@ -374,24 +450,56 @@ void ThiefBot::damageEffect()
     }
 }
 
+void ThiefBot::dropGoodie()
+{
+    Actor* goodie = getWorld()->newGoodie(m_carriedGoodie, getX(), getY());
+    
+    if (goodie == nullptr)
+        return;
+    
+    getWorld()->addActor(goodie);
+    m_carriedGoodie = NUM_TYPES;
+}
+
+void ThiefBot::saveState(SnapshotWriter& out) const
+{
+    Robot::saveState(out);
+    out.putI16(m_distanceBeforeTurning);
+    out.putI16(m_distanceTraveled);
+    out.putI32(m_rollsBeforeSteal);
+    out.putU8(m_carriedGoodie);
+}
+
+void ThiefBot::loadState(SnapshotReader& in)
+{
+    Robot::loadState(in);
+    m_distanceBeforeTurning = in.getI16();
+    m_distanceTraveled = in.getI16();
+    m_rollsBeforeSteal = in.getI32();
+    
+    // Anything that is not a goodie type means no goodie is carried
+    unsigned carried = in.getU8();
+    m_carriedGoodie = (carried == EXTRA_LIFE_GOODIE || carried == RESTORE_HEALTH_GOODIE || carried == AMMO_GOODIE) ? Type(carried) : NUM_TYPES;
+}
+
 // MeanThiefBot
-MeanThiefBot::MeanThiefBot(StudentWorld* world, double startX, double startY)
-: ThiefBot(world, MEAN_THIEFBOT_INITIAL_HEALTH, IID_MEAN_THIEFBOT, startX, startY) {}
+MeanThiefBot::MeanThiefBot(StudentWorld* world, int startX, int startY)
+: ThiefBot(world, MEAN_THIEFBOT, MEAN_THIEFBOT_INITIAL_HEALTH, IID_MEAN_THIEFBOT, startX, startY) {}
 
 // Marble
-Marble::Marble(StudentWorld* world, double startX, double startY)
-: CanBeAttacked(world, MARBLE_INITIAL_HEALTH, IID_MARBLE, startX, startY, none) {}
+Marble::Marble(StudentWorld* world, int startX, int startY)
+: CanBeAttacked(world, MARBLE, MARBLE_INITIAL_HEALTH, IID_MARBLE, startX, startY, none, ATTRIBUTES) {}
 
 void Marble::push()
 {
     // Use adjusted x and y coordinates according to the player's direction to determine if a marble is pushable
-    double x = getX();
-    double y = getY();
+    int x = getX();
+    int y = getY();
     adjustPosFromDir(getWorld()->getPlayer()->getDirection(), x, y);
-    Actor* allowsMarbleMovementAt = getWorld()->allowsMarbleMovementAt(x, y);
+    unsigned attributesAt = getWorld()->attributesAt(x, y);
     
     // If there is a pit or an empty space adjacent to the marble in the direction of the player's direction, movement is allowed
-    if (allowsMarbleMovementAt != nullptr || getWorld()->anyActorAt(x, y) == nullptr)
+    if ((attributesAt & ALLOWS_MARBLE_MOVEMENT) || ! (attributesAt & OCCUPIES_SQUARE))
         move(getWorld()->getPlayer()->getDirection());
 }
 
@@ -402,67 +510,82 @@ void Marble::damageEffect()
 }
 
 // ThiefBotFactory
-ThiefBotFactory::ThiefBotFactory(StudentWorld* world, double startX, double startY)
-: Actor(world, IID_ROBOT_FACTORY, startX, startY, none) {}
+ThiefBotFactory::ThiefBotFactory(StudentWorld* world, int startX, int startY, Type type)
+: Actor(world, type, IID_ROBOT_FACTORY, startX, startY, none, ATTRIBUTES), m_census(0), m_nextBirthTick(0) {}
 
 void ThiefBotFactory::doSomething()
 {
+    // The factory is only woken up on the ticks its 1 in FACTORY_BIRTH_ODDS roll succeeds
+    scheduleNextBirth(getWorld()->getTick());
+    
     // Use the number of ThiefBots in the surrounding area to determine if a factory can create another ThiefBot on its square
-    if (countThiefBots() < 3 && getWorld()->countedByFactoriesAt(getX(), getY()) == nullptr)
+    if (m_census < 3 && ! getWorld()->hasAttributeAt<COUNTED_BY_FACTORIES>(getX(), getY()))
     {
-        if (randInt(1, 50) == 1)
-        {   
-            // (Regular) ThiefBot factories produce (regular) ThiefBots
-            // Mean ThiefBot factories produce mean ThiefBots
-            createNewThiefBot();
-            getWorld()->playSound(SOUND_ROBOT_BORN);
-        }
+        // (Regular) ThiefBot factories produce (regular) ThiefBots
+        // Mean ThiefBot factories produce mean ThiefBots
+        createNewThiefBot();
+        getWorld()->playSound(SOUND_ROBOT_BORN);
     }
 }
 
-int ThiefBotFactory::countThiefBots()
+void ThiefBotFactory::scheduleNextBirth(int lastTick)
 {
-    // Count ThiefBots of any type in a 7 x 7 area
-    int count = 0;
-    
-    for (int x = getX() - 3; x <= getX() + 3; x++)
-        for (int y = getY() - 3; y <= getY() + 3; y++)
-        {
-            if (x < 0 || x >= VIEW_WIDTH || y < 0 || y >= VIEW_HEIGHT)
-                continue;
-                        
-            if (getWorld()->countedByFactoriesAt(x, y) != nullptr)
-                count++;
-        }
+    // A factory rolls for a new ThiefBot every tick, and the roll does not depend on whether there is room for one,
+    // so waking up only on the tick of the next successful roll and checking for room then gives the same births
+    m_nextBirthTick = lastTick + getWorld()->randTrialsUntilSuccess(FACTORY_BIRTH_ODDS);
+    getWorld()->scheduleAction(this, m_nextBirthTick);
+    getWorld()->actorChanged(this);
+}
+
+void ThiefBotFactory::takeCensus()
+{
+    // Count the squares holding ThiefBots of any type in a 7 x 7 area from scratch
+    m_census = 0;
     
-    return count;
+    for (int x = getX() - CENSUS_RADIUS; x <= getX() + CENSUS_RADIUS; x++)
+        for (int y = getY() - CENSUS_RADIUS; y <= getY() + CENSUS_RADIUS; y++)
+            if (getWorld()->hasAttributeAt<COUNTED_BY_FACTORIES>(x, y))
+                m_census++;
 }
 
 void ThiefBotFactory::createNewThiefBot() const
 {
-    getWorld()->addActor(new ThiefBot(getWorld(), THIEFBOT_INITIAL_HEALTH, IID_THIEFBOT, getX(), getY()));
+    getWorld()->addActor(getWorld()->newThiefBot(getX(), getY()));
 }
 
 // MeanThiefBotFactory
-MeanThiefBotFactory::MeanThiefBotFactory(StudentWorld* world, double startX, double startY)
-: ThiefBotFactory(world, startX, startY) {}
+void ThiefBotFactory::saveState(SnapshotWriter& out) const
+{
+    // The census is counted again from the board, but the tick of the next birth is part of the factory's state
+    Actor::saveState(out);
+    out.putI32(m_nextBirthTick);
+}
+
+void ThiefBotFactory::loadState(SnapshotReader& in)
+{
+    Actor::loadState(in);
+    m_nextBirthTick = in.getI32();
+}
+
+MeanThiefBotFactory::MeanThiefBotFactory(StudentWorld* world, int startX, int startY)
+: ThiefBotFactory(world, startX, startY, MEAN_THIEFBOT_FACTORY) {}
 
 void MeanThiefBotFactory::createNewThiefBot() const
 {
-    getWorld()->addActor(new MeanThiefBot(getWorld(), getX(), getY()));
+    getWorld()->addActor(getWorld()->newMeanThiefBot(getX(), getY()));
 }
 
 // Collectable
-Collectable::Collectable(StudentWorld* world, int imageID, double startX, double startY)
-: Actor(world, imageID, startX, startY, none), m_canCollect(true) {}
+Collectable::Collectable(StudentWorld* world, Type type, int imageID, int startX, int startY, unsigned attributes)
+: Actor(world, type, imageID, startX, startY, none, ATTRIBUTES | attributes) {}
 
-void Collectable::doSomething()
+void Collectable::onEnter(Actor* visitor)
 {
     if ( ! isAlive())
         return;
     
-    // The player can collect a collectable if they step on it, unless it is currently being held by a ThiefBot
-    if (m_canCollect && getWorld()->getPlayer()->isAt(getX(), getY()))
+    // The player can collect a collectable if they step on it (goodies held by ThiefBots are not on the board)
+    if (visitor->getType() == AVATAR)
     {
         setStatus(DEAD);
         getWorld()->playSound(SOUND_GOT_GOODIE);
@@ -472,8 +595,8 @@ void Collectable::doSomething()
 }
 
 // ExtraLifeGoodie
-ExtraLifeGoodie::ExtraLifeGoodie(StudentWorld* world, double startX, double startY)
-: Collectable(world, IID_EXTRA_LIFE, startX, startY) {}
+ExtraLifeGoodie::ExtraLifeGoodie(StudentWorld* world, int startX, int startY)
+: Collectable(world, EXTRA_LIFE_GOODIE, IID_EXTRA_LIFE, startX, startY, ATTRIBUTES) {}
 
 void ExtraLifeGoodie::giveBenefits()
 {
@@ -482,8 +605,8 @@ void ExtraLifeGoodie::giveBenefits()
 }
 
 // RestoreHealthGoodie
-RestoreHealthGoodie::RestoreHealthGoodie(StudentWorld* world, double startX, double startY)
-: Collectable(world, IID_RESTORE_HEALTH, startX, startY) {}
+RestoreHealthGoodie::RestoreHealthGoodie(StudentWorld* world, int startX, int startY)
+: Collectable(world, RESTORE_HEALTH_GOODIE, IID_RESTORE_HEALTH, startX, startY, ATTRIBUTES) {}
 
 void RestoreHealthGoodie::giveBenefits()
 {
@@ -492,8 +615,8 @@ void RestoreHealthGoodie::giveBenefits()
 }
 
 // AmmoGoodie
-AmmoGoodie::AmmoGoodie(StudentWorld* world, double startX, double startY)
-: Collectable(world, IID_AMMO, startX, startY) {}
+AmmoGoodie::AmmoGoodie(StudentWorld* world, int startX, int startY)
+: Collectable(world, AMMO_GOODIE, IID_AMMO, startX, startY, ATTRIBUTES) {}
 
 void AmmoGoodie::giveBenefits()
 {
@@ -502,119 +625,71 @@ void AmmoGoodie::giveBenefits()
 }
 
 // Crystal
-Crystal::Crystal(StudentWorld* world, double startX, double startY)
-: Collectable(world, IID_CRYSTAL, startX, startY) {}
+Crystal::Crystal(StudentWorld* world, int startX, int startY)
+: Collectable(world, CRYSTAL, IID_CRYSTAL, startX, startY) {}
 
 void Crystal::giveBenefits()
 {
     getWorld()->increaseScore(50);
     getWorld()->getPlayer()->addCrystal();
+    
+    // Collecting the last crystal is what reveals the exit
+    if (getWorld()->hasCollectedAllCrystals())
+        getWorld()->revealExit();
 }
 
-// Wall
-Wall::Wall(StudentWorld* world, double startX, double startY)
-: Actor(world, IID_WALL, startX, startY, none) {}
-
 // Pit
-Pit::Pit(StudentWorld* world, double startX, double startY)
-: Actor(world, IID_PIT, startX, startY, none) {}
+Pit::Pit(StudentWorld* world, int startX, int startY)
+: Actor(world, PIT, IID_PIT, startX, startY, none, ATTRIBUTES) {}
 
-void Pit::doSomething()
+void Pit::onEnter(Actor* visitor)
 {
     if ( ! isAlive())
         return;
     
-    Actor* canBeSwallowedAt = getWorld()->canBeSwallowedAt(getX(), getY());
-    
-    // If there is a marble and a pit on the same square, destroy both objects
-    if (canBeSwallowedAt != nullptr)
+    // If a marble is pushed onto the pit, destroy both objects
+    if (visitor->hasAttribute(CAN_BE_SWALLOWED))
     {
         setStatus(DEAD);
-        canBeSwallowedAt->setStatus(DEAD);
+        visitor->setStatus(DEAD);
     }
 }
 
 // Exit
-Exit::Exit(StudentWorld* world, double startX, double startY)
-: Actor(world, IID_EXIT, startX, startY, none), m_isVisible(false) { setVisible(false); }   // Starts off invisible
+Exit::Exit(StudentWorld* world, int startX, int startY)
+: Actor(world, EXIT, IID_EXIT, startX, startY, none, ATTRIBUTES), m_isVisible(false) { setVisible(false); }   // Starts off invisible
 
-void Exit::doSomething()
+void Exit::reveal()
 {
-    // If the player has collected all the crystals and the exit is invisible,
-    if (getWorld()->hasCollectedAllCrystals() && ! m_isVisible)
+    // Called once the player has collected all the crystals:
+    // expose the maze and make sure SOUND_REVEAL_EXIT is only played once
+    if ( ! m_isVisible)
     {
-        // expose the maze and make sure SOUND_REVEAL_EXIT is only played once
         m_isVisible = true;
         setVisible(true);
+        getWorld()->actorChanged(this);
         getWorld()->playSound(SOUND_REVEAL_EXIT);
     }
-    
+}
+
+void Exit::onEnter(Actor* visitor)
+{
     // If the player has stepped on the exit while it is visible, the level has been completed
-    if (getWorld()->getPlayer()->isAt(getX(), getY()) && m_isVisible)
+    if (visitor->getType() == AVATAR && m_isVisible)
     {
         getWorld()->playSound(SOUND_FINISHED_LEVEL);
         getWorld()->setCompletedLevel(true);
     }
 }
 
-// Pea
-Pea::Pea(StudentWorld* world, double startX, double startY, int dir)
-: Actor(world, IID_PEA, startX, startY, dir) {}
+void Exit::saveState(SnapshotWriter& out) const
+{
+    Actor::saveState(out);
+    out.putU8(m_isVisible);
+}
 
-void Pea::doSomething()
+void Exit::loadState(SnapshotReader& in)
 {
-    if ( ! isAlive())
-        return;
-    
-    Avatar* player = getWorld()->getPlayer();
-    
-    // If the pea hits a player, damage the player
-    if (player->isAt(getX(), getY()))
-    {
-        player->damage();
-        setStatus(DEAD);
-        return;
-    }
-    
-    Actor* canBeAttackedAt = getWorld()->canBeAttackedAt(getX(), getY());
-    
-    // If the pea hits an object that can be attacked, damage that object
-    if (canBeAttackedAt != nullptr)
-    {
-        canBeAttackedAt->damage();
-        setStatus(DEAD);
-        return;
-    }
-    // If the pea hits an object that blocks peas, do nothing to that object
-    else if (getWorld()->blocksPeaMovementAt(getX(), getY()) != nullptr)
-    {
-        setStatus(DEAD);
-        return;
-    }
-    
-    move(getDirection());
-    
-    // Check again: If the pea hits a player, damage the player
-    if (player->isAt(getX(), getY()))
-    {
-        player->damage();
-        setStatus(DEAD);
-        return;
-    }
-    
-    canBeAttackedAt = getWorld()->canBeAttackedAt(getX(), getY());
-    
-    // Check again: If the pea hits an object that can be attacked, damage that object
-    if (canBeAttackedAt != nullptr)
-    {
-        canBeAttackedAt->damage();
-        setStatus(DEAD);
-        return;
-    }
-    // Check again: If the pea hits an object that blocks peas, do nothing to that object
-    else if (getWorld()->blocksPeaMovementAt(getX(), getY()) != nullptr)
-    {
-        setStatus(DEAD);
-        return;
-    }
+    Actor::loadState(in);
+    m_isVisible = (in.getU8() != 0);
 }
@@ -12,6 +12,7 @@
 #include <iostream>
 #include <string>
 #include <map>
+#include <set>
 #include <utility>
 #include <cstdlib>
 #include <algorithm>
@@ -203,8 +204,7 @@ void GameController::run(int argc, char* argv[], GameWorld* gw, string windowTit
 
 	glutSetOption(GLUT_ACTION_ON_WINDOW_CLOSE, GLUT_ACTION_GLUTMAINLOOP_RETURNS);
 	glutMainLoop();
-	delete m_gw;
-	reportLeakedGraphObjects();
+	delete m_gw;	// Reports any leaked GraphObjects
 }
 
 void GameController::keyboardEvent(unsigned char key, int /* x */, int /* y */)
@@ -414,10 +414,36 @@ void GameController::displayGamePlay()
 #pragma GCC diagnostic pop
 #endif
 
-  std::set<GraphObject*> &graphObjects = GraphObject::getGraphObjects();
+  const GraphObjectRegistry& graphObjects = *m_gw->getGraphObjects();
 
 	for (int i = GraphObject::NUM_DEPTHS - 1; i >= 0; --i)
 	{
+		  // Static scenery comes straight from the world's terrain layer
+		for (int y = 0; y < VIEW_HEIGHT; y++)
+			for (int x = 0; x < VIEW_WIDTH; x++)
+			{
+				int imageID = m_gw->getTerrainImageAt(x, y);
+				if (imageID != IID_NONE && m_imageDepthMap.at(imageID) == i)
+				{
+					double gx, gy, gz;
+					convertToGlutCoords(x, y, gx, gy, gz);
+					m_spriteManager.plotSprite(imageID, 0, gx, gy, gz, GraphObject::none, 1.0);
+				}
+			}
+
+		  // So do the projectiles in flight
+		for (int p = 0; p < m_gw->getNumProjectiles(); p++)
+		{
+			int imageID, x, y, direction;
+			m_gw->getProjectile(p, imageID, x, y, direction);
+			if (imageID != IID_NONE && m_imageDepthMap.at(imageID) == i)
+			{
+				double gx, gy, gz;
+				convertToGlutCoords(x, y, gx, gy, gz);
+				m_spriteManager.plotSprite(imageID, 0, gx, gy, gz, direction, 1.0);
+			}
+		}
+
 		for (auto it = graphObjects.begin(); it != graphObjects.end(); it++)
 		{
 			GraphObject* cur = *it;
@@ -442,10 +468,9 @@ void GameController::displayGamePlay()
 	glutSwapBuffers();
 }
 
-void GameController::reportLeakedGraphObjects() const
+void GameController::reportLeakedGraphObjects(const GraphObjectRegistry& graphObjects) const
 {
 	//int totalLeaked = 0;
-	auto& graphObjects = GraphObject::getGraphObjects();
 	if (graphObjects.empty())
 		cerr << "No memory leaks were detected." << endl;
 	else
@@ -4,8 +4,28 @@
 #include <cstdlib>
 using namespace std;
 
+  // A world without a controller (ex: in a benchmark) runs headless: no sounds, no status line, and only the keys
+  // given to it with pressKey
+
+GameWorld::~GameWorld()
+{
+	  // The derived world has freed its objects by now, so anything still registered was leaked
+	if (m_controller != nullptr)
+		m_controller->reportLeakedGraphObjects(m_graphObjects);
+}
+
 bool GameWorld::getKey(int& value)
 {
+	if (m_controller == nullptr)
+	{
+		if (m_headlessKey == 0)
+			return false;
+
+		value = m_headlessKey;
+		m_headlessKey = 0;
+		return true;
+	}
+
 	bool gotKey = m_controller->getKeyIfAny(value);
 
 	if (gotKey)
@@ -18,10 +38,16 @@ bool GameWorld::getKey(int& value)
 
 void GameWorld::playSound(int soundID)
 {
+	if (m_controller == nullptr)
+		return;
+
 	m_controller->playSound(soundID);
 }
 
 void GameWorld::setGameStatText(string text)
 {
+	if (m_controller == nullptr)
+		return;
+
 	m_controller->setGameStatText(text);
 }
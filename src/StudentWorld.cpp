@@ -8,7 +8,11 @@ using namespace std;
 #include <sstream>
 #include <iomanip>
 #include <vector>
+#include <algorithm>
+#include <random>
+#include <cassert>
 #include "Actor.h"
+#include "Snapshot.h"
 
 GameWorld* createStudentWorld(string assetPath)
 {
@@ -18,322 +22,1465 @@ GameWorld* createStudentWorld(string assetPath)
 // Students:  Add code to this file, StudentWorld.h, Actor.h, and Actor.cpp
 
 StudentWorld::StudentWorld(string assetPath)
-: GameWorld(assetPath), m_avatar(nullptr), m_bonus(INITIAL_BONUS), m_crystals(0), m_completedLevel(false) {}
+: GameWorld(assetPath), m_bonus(INITIAL_BONUS), m_crystals(0), m_completedLevel(false), m_revealExitPending(false), m_peasFired(0), m_actorOrder(INSERTION_ORDER), m_tick(1), m_stateHash(0), m_terrain(), m_peaCounts(), m_squareAttributes(), m_playerSightValid(false)
+{
+    // Unless a seed is given, every game is different
+    random_device device;
+    m_random.reseed((static_cast<unsigned long long>(device()) << 32) ^ device());
+}
+
+StudentWorld::StudentWorld(const StudentWorld& parent)
+: GameWorld(parent), m_player(parent.m_player), m_bonus(parent.m_bonus), m_crystals(parent.m_crystals), m_completedLevel(parent.m_completedLevel),
+  m_revealExitPending(parent.m_revealExitPending), m_slots(parent.m_slots), m_freeSlots(parent.m_freeSlots), m_peasFired(parent.m_peasFired),
+  m_actorOrder(parent.m_actorOrder), m_tick(parent.m_tick), m_random(parent.m_random),
+  m_stateHash(parent.m_stateHash), m_levelTemplate(parent.m_levelTemplate), m_peas(parent.m_peas),
+  m_playerSight(parent.m_playerSight), m_playerSightValid(parent.m_playerSightValid)
+{
+    // Copy every actor (the player included) into this world, in the slot it has in the parent
+    for (int i = 0; i != m_slots.size(); i++)
+        if (m_slots[i].actor != nullptr)
+            m_slots[i].actor = copyActor(m_slots[i].actor);
+    
+    // Then copy every list of actors, with the copies in place of the originals
+    copyActorList(parent.m_actors, m_actors);
+    copyActorList(parent.m_spawned, m_spawned);
+    
+    for (int i = 0; i != Actor::NUM_TYPES; i++)
+    {
+        copyActorList(parent.m_groups[i], m_groups[i]);
+        m_wheels[i] = parent.m_wheels[i];
+    }
+    
+    for (int y = 0; y < VIEW_HEIGHT; y++)
+        for (int x = 0; x < VIEW_WIDTH; x++)
+        {
+            copyActorList(parent.m_grid[y][x], m_grid[y][x]);
+            m_terrain[y][x] = parent.m_terrain[y][x];
+            m_peaCounts[y][x] = parent.m_peaCounts[y][x];
+            m_squareAttributes[y][x] = parent.m_squareAttributes[y][x];
+        }
+    
+    for (int i = 0; i < Actor::NUM_ATTRIBUTES; i++)
+        m_attributeBoards[i] = parent.m_attributeBoards[i];
+}
+
+StudentWorld::~StudentWorld()
+{
+    clearActors();
+}
+
+StudentWorld* StudentWorld::fork() const
+{
+    return new StudentWorld(*this);
+}
+
+Actor* StudentWorld::copyActor(const Actor* actor)
+{
+    // A copy comes from the same kind of storage as a new actor of its type would
+    Actor* copy = nullptr;
+    
+    switch (actor->getType())
+    {
+        case Actor::AVATAR:                 copy = copyInArena<Avatar>(actor); break;
+        case Actor::RAGEBOT:                copy = copyInArena<RageBot>(actor); break;
+        case Actor::THIEFBOT:               copy = m_thiefBotPool.create(*static_cast<const ThiefBot*>(actor)); break;
+        case Actor::MEAN_THIEFBOT:          copy = m_meanThiefBotPool.create(*static_cast<const MeanThiefBot*>(actor)); break;
+        case Actor::MARBLE:                 copy = copyInArena<Marble>(actor); break;
+        case Actor::THIEFBOT_FACTORY:       copy = copyInArena<ThiefBotFactory>(actor); break;
+        case Actor::MEAN_THIEFBOT_FACTORY:  copy = copyInArena<MeanThiefBotFactory>(actor); break;
+        case Actor::EXTRA_LIFE_GOODIE:      copy = copyInArena<ExtraLifeGoodie>(actor); break;
+        case Actor::RESTORE_HEALTH_GOODIE:  copy = copyInArena<RestoreHealthGoodie>(actor); break;
+        case Actor::AMMO_GOODIE:            copy = copyInArena<AmmoGoodie>(actor); break;
+        case Actor::CRYSTAL:                copy = copyInArena<Crystal>(actor); break;
+        case Actor::PIT:                    copy = copyInArena<Pit>(actor); break;
+        case Actor::EXIT:                   copy = copyInArena<Exit>(actor); break;
+        case Actor::NUM_TYPES:              return nullptr;
+    }
+    
+    copy->setWorld(this);
+    return copy;
+}
+
+void StudentWorld::copyActorList(const vector<Actor*>& from, vector<Actor*>& to) const
+{
+    // The copy of an actor is found through the slot it shares with the original
+    to.resize(from.size());
+    
+    for (int i = 0; i != from.size(); i++)
+        to[i] = m_slots[from[i]->getHandle().index()].actor;
+}
+
+// Every snapshot starts with these bytes and then its version
+static const unsigned char SNAPSHOT_MAGIC[] = { 'M', 'M', 'S', 'N' };
+
+// Actors are saved with the slot they had, which the rest of the snapshot uses to refer to them
+static void saveActor(SnapshotWriter& out, const Actor* actor)
+{
+    out.putU8(actor->getType());
+    out.putU32(actor->getHandle().index());
+    out.putI16(actor->getX());
+    out.putI16(actor->getY());
+    actor->saveState(out);
+}
+
+// Gets the tick on which a robot or factory acts next, returning false for actors that never act on their own
+static bool getPlannedTick(const Actor* actor, int& tick)
+{
+    switch (actor->getType())
+    {
+        case Actor::RAGEBOT:
+        case Actor::THIEFBOT:
+        case Actor::MEAN_THIEFBOT:
+            tick = static_cast<const Robot*>(actor)->getNextTick();
+            return true;
+        case Actor::THIEFBOT_FACTORY:
+        case Actor::MEAN_THIEFBOT_FACTORY:
+            tick = static_cast<const ThiefBotFactory*>(actor)->getNextBirthTick();
+            return true;
+        default:
+            return false;
+    }
+}
+
+// The actor loaded for a slot of the saved world, or nullptr if no actor had that slot
+static Actor* actorForSlot(const vector<Actor*>& bySlot, uint32_t slot)
+{
+    return slot < bySlot.size() ? bySlot[slot] : nullptr;
+}
+
+size_t StudentWorld::saveSnapshot(unsigned char* buffer, size_t capacity) const
+{
+    SnapshotWriter out(buffer, capacity);
+    
+    for (int i = 0; i != sizeof(SNAPSHOT_MAGIC); i++)
+        out.putU8(SNAPSHOT_MAGIC[i]);
+    out.putI16(SNAPSHOT_VERSION);
+    
+    // The player's progress and the rest of the state that belongs to no actor
+    out.putI32(getLevel());
+    out.putI32(getLives());
+    out.putI32(getScore());
+    out.putI32(m_bonus);
+    out.putI32(m_crystals);
+    out.putI32(m_tick);
+    out.putU8((m_completedLevel ? 1 : 0) | (m_revealExitPending ? 2 : 0));
+    
+    for (int i = 0; i < 4; i++)
+        out.putU64(m_random.getState(i));
+    
+    // The player, then every group in the order its actors act, so loading them in the same order restores the groups
+    // Between ticks every actor is in its group (move merges the spawn buffer after the peas), and every dead actor
+    // has already been removed
+    uint32_t actors = 1;
+    
+    for (int i = 0; i != Actor::NUM_TYPES; i++)
+        actors += m_groups[i].size();
+    
+    out.putU32(actors);
+    saveActor(out, getPlayer());
+    
+    for (int i = 0; i != Actor::NUM_TYPES; i++)
+        for (int j = 0; j != m_groups[i].size(); j++)
+            saveActor(out, m_groups[i][j]);
+    
+    // Actors sharing a square are found in the order they arrived on it, which the groups do not record
+    uint32_t stacked = 0;
+    
+    for (int y = 0; y < VIEW_HEIGHT; y++)
+        for (int x = 0; x < VIEW_WIDTH; x++)
+            if (m_grid[y][x].size() > 1)
+                stacked++;
+    
+    out.putU32(stacked);
+    
+    for (int y = 0; y < VIEW_HEIGHT; y++)
+        for (int x = 0; x < VIEW_WIDTH; x++)
+            if (m_grid[y][x].size() > 1)
+            {
+                out.putU8(x);
+                out.putU8(y);
+                out.putI16(m_grid[y][x].size());
+                
+                for (int i = 0; i != m_grid[y][x].size(); i++)
+                    out.putU32(m_grid[y][x][i]->getHandle().index());
+            }
+    
+    // The timing wheels, slot by slot, so actors due on the same tick are still handed out in the same order
+    uint32_t scheduled = 0;
+    
+    for (int i = 0; i != Actor::NUM_TYPES; i++)
+        for (int s = 0; s != TimingWheel<ActorHandle>::NUM_SLOTS; s++)
+            for (int j = 0; j != m_wheels[i].entriesIn(s).size(); j++)
+                if (resolve(m_wheels[i].entriesIn(s)[j].item) != nullptr)
+                    scheduled++;
+    
+    out.putU32(scheduled);
+    
+    for (int i = 0; i != Actor::NUM_TYPES; i++)
+        for (int s = 0; s != TimingWheel<ActorHandle>::NUM_SLOTS; s++)
+            for (int j = 0; j != m_wheels[i].entriesIn(s).size(); j++)
+            {
+                const TimingWheel<ActorHandle>::Entry& entry = m_wheels[i].entriesIn(s)[j];
+                
+                if (resolve(entry.item) != nullptr)
+                {
+                    out.putI32(entry.tick);
+                    out.putU32(entry.item.index());
+                }
+            }
+    
+    // The peas in flight, in the order they were fired
+    out.putU32(m_peas.size());
+    
+    for (int i = 0; i != m_peas.size(); i++)
+    {
+        out.putI16(m_peas.x[i]);
+        out.putI16(m_peas.y[i]);
+        out.putI16(m_peas.direction[i]);
+    }
+    
+    return out.size();
+}
+
+bool StudentWorld::loadSnapshot(const unsigned char* data, size_t size)
+{
+    SnapshotReader in(data, size);
+    
+    // Leave the world alone unless the data at least starts like a snapshot of this version
+    for (int i = 0; i != sizeof(SNAPSHOT_MAGIC); i++)
+        if (in.getU8() != SNAPSHOT_MAGIC[i])
+            return false;
+    
+    if (in.getI16() != SNAPSHOT_VERSION)
+        return false;
+    
+    int level = in.getI32();
+    int lives = in.getI32();
+    int score = in.getI32();
+    int bonus = in.getI32();
+    int crystals = in.getI32();
+    int tick = in.getI32();
+    unsigned flags = in.getU8();
+    uint64_t random[4];
+    
+    for (int i = 0; i < 4; i++)
+        random[i] = in.getU64();
+    
+    if (in.failed() || tick < 1)
+        return false;
+    
+    // Replace the level in play with a fresh copy of the saved one, and put the saved actors on it
+    clearActors();
+    restoreProgress(lives, score, level);
+    m_bonus = bonus;
+    m_crystals = crystals;
+    m_tick = tick;
+    m_completedLevel = (flags & 1) != 0;
+    m_revealExitPending = (flags & 2) != 0;
+    
+    if (prepareLevel() != GWSTATUS_CONTINUE_GAME || ! loadLevelState(in) || in.failed() || ! in.atEnd())
+    {
+        clearActors();
+        return false;
+    }
+    
+    // Making ThiefBots uses random numbers, so the generator is put back last
+    for (int i = 0; i < 4; i++)
+        m_random.setState(i, random[i]);
+    
+    updateDisplayText();
+    return true;
+}
+
+bool StudentWorld::loadLevelState(SnapshotReader& in)
+{
+    // The actors, made and put on the board in the order they were saved; the first is the player
+    vector<Actor*> bySlot;
+    uint32_t actors = in.getU32();
+    uint32_t planners = 0;
+    
+    for (uint32_t i = 0; i < actors && ! in.failed(); i++)
+    {
+        unsigned type = in.getU8();
+        uint32_t slot = in.getU32();
+        int x = in.getI16();
+        int y = in.getI16();
+        
+        if (type >= Actor::NUM_TYPES || (type == Actor::AVATAR) != (i == 0) || ! isOnBoard(x, y) || slot > ActorHandle::INDEX_MASK
+            || actorForSlot(bySlot, slot) != nullptr)
+            return false;
+        
+        Actor* actor = newActor(Actor::Type(type), x, y);
+        actor->loadState(in);
+        
+        int tick;
+        if (getPlannedTick(actor, tick))
+            planners++;
+        
+        if (i == 0)
+        {
+            assignHandle(actor);
+            m_player = actor->getHandle();
+        }
+        else
+            addActor(actor);
+        
+        if (slot >= bySlot.size())
+            bySlot.resize(slot + 1, nullptr);
+        bySlot[slot] = actor;
+    }
+    
+    if (getPlayer() == nullptr)
+        return false;
+    
+    // The actors join their groups without being scheduled, since the saved schedules are put back below
+    // Every actor is on the board by now, so the factories count the right ThiefBots
+    for (int i = 0; i != m_spawned.size(); i++)
+        joinGroup(m_spawned[i]);
+    
+    m_spawned.clear();
+    
+    // Put the actors of each stacked square back in the order they arrived on it
+    uint32_t stacked = in.getU32();
+    
+    for (uint32_t i = 0; i < stacked && ! in.failed(); i++)
+    {
+        int x = in.getU8();
+        int y = in.getU8();
+        int count = in.getI16();
+        
+        if ( ! isOnBoard(x, y) || count != m_grid[y][x].size())
+            return false;
+        
+        vector<Actor*>& cell = m_grid[y][x];
+        
+        for (int j = 0; j < count; j++)
+        {
+            vector<Actor*>::iterator it = find(cell.begin() + j, cell.end(), actorForSlot(bySlot, in.getU32()));
+            
+            if (it == cell.end())
+                return false;
+            
+            iter_swap(cell.begin() + j, it);
+        }
+    }
+    
+    // Every robot and factory is due exactly once, on the tick it plans to act next
+    uint32_t scheduled = in.getU32();
+    vector<bool> isScheduled(bySlot.size(), false);
+    
+    for (uint32_t i = 0; i < scheduled && ! in.failed(); i++)
+    {
+        int tick = in.getI32();
+        uint32_t slot = in.getU32();
+        Actor* actor = actorForSlot(bySlot, slot);
+        
+        int planned;
+        
+        if (actor == nullptr || isScheduled[slot] || ! getPlannedTick(actor, planned) || tick != planned || tick < m_tick)
+            return false;
+        
+        isScheduled[slot] = true;
+        scheduleAction(actor, tick);
+    }
+    
+    if (scheduled != planners)
+        return false;
+    
+    uint32_t peas = in.getU32();
+    
+    for (uint32_t i = 0; i < peas && ! in.failed(); i++)
+    {
+        int x = in.getI16();
+        int y = in.getI16();
+        int direction = in.getI16();
+        
+        if ( ! isOnBoard(x, y) || (direction != GraphObject::right && direction != GraphObject::left
+                                   && direction != GraphObject::up && direction != GraphObject::down))
+            return false;
+        
+        m_peas.add(x, y, direction);
+        addPeaTo(x, y);
+        m_stateHash ^= peaKey(x, y, direction);
+    }
+    
+    return true;
+}
+
+Actor* StudentWorld::newActor(Actor::Type type, int x, int y)
+{
+    // Each actor comes from the same kind of storage as it would in a level started by init
+    switch (type)
+    {
+        case Actor::AVATAR:                 return m_levelArena.create<Avatar>(this, x, y);
+        case Actor::RAGEBOT:                return m_levelArena.create<RageBot>(this, x, y);
+        case Actor::THIEFBOT:               return newThiefBot(x, y);
+        case Actor::MEAN_THIEFBOT:          return newMeanThiefBot(x, y);
+        case Actor::MARBLE:                 return m_levelArena.create<Marble>(this, x, y);
+        case Actor::THIEFBOT_FACTORY:       return m_levelArena.create<ThiefBotFactory>(this, x, y);
+        case Actor::MEAN_THIEFBOT_FACTORY:  return m_levelArena.create<MeanThiefBotFactory>(this, x, y);
+        case Actor::EXTRA_LIFE_GOODIE:
+        case Actor::RESTORE_HEALTH_GOODIE:
+        case Actor::AMMO_GOODIE:            return newGoodie(type, x, y);
+        case Actor::CRYSTAL:                return m_levelArena.create<Crystal>(this, x, y);
+        case Actor::PIT:                    return m_levelArena.create<Pit>(this, x, y);
+        case Actor::EXIT:                   return m_levelArena.create<Exit>(this, x, y);
+        case Actor::NUM_TYPES:              break;
+    }
+    
+    return nullptr;
+}
+
+int StudentWorld::init()
+{
+    int result = prepareLevel();
+    
+    if (result != GWSTATUS_CONTINUE_GAME)
+        return result;
+    
+    const LevelTemplate& level = *m_levelTemplate;
+    
+    m_crystals = 0;
+    m_tick = 1;
+    
+    // Allocate and insert actors into the game world, as required by the specification in the current level’s data file
+    // They all come from the level's arena, which cleanUp releases in one step once their destructors have run
+    for (int i = 0; i != level.spawns.size(); i++)
+    {
+        int x = level.spawns[i].x;
+        int y = level.spawns[i].y;
+        
+        switch (level.spawns[i].item)
+        {
+            case Level::exit:
+                addActor(m_levelArena.create<Exit>(this, x, y));
+                break;
+            case Level::player:
+            {
+                Avatar* player = m_levelArena.create<Avatar>(this, x, y);
+                assignHandle(player);
+                m_player = player->getHandle();
+                break;
+            }
+            case Level::horiz_ragebot:
+                addActor(m_levelArena.create<RageBot>(this, x, y));
+                break;
+            case Level::vert_ragebot:
+                addActor(m_levelArena.create<RageBot>(this, x, y, 270));
+                break;
+            case Level::thiefbot_factory:
+                addActor(m_levelArena.create<ThiefBotFactory>(this, x, y));
+                break;
+            case Level::mean_thiefbot_factory:
+                addActor(m_levelArena.create<MeanThiefBotFactory>(this, x, y));
+                break;
+            case Level::marble:
+                addActor(m_levelArena.create<Marble>(this, x, y));
+                break;
+            case Level::pit:
+                addActor(m_levelArena.create<Pit>(this, x, y));
+                break;
+            case Level::crystal:
+                addActor(m_levelArena.create<Crystal>(this, x, y));
+                m_crystals++;
+                break;
+            case Level::restore_health:
+                addActor(m_levelArena.create<RestoreHealthGoodie>(this, x, y));
+                break;
+            case Level::extra_life:
+                addActor(m_levelArena.create<ExtraLifeGoodie>(this, x, y));
+                break;
+            case Level::ammo:
+                addActor(m_levelArena.create<AmmoGoodie>(this, x, y));
+                break;
+            default:
+                // Walls are part of the terrain and empty squares hold nothing, so neither is ever in the spawn list
+                break;
+        }
+    }
+    
+    // Start the bonus points at 1000
+    m_bonus = INITIAL_BONUS;
+    
+    // Put the new actors into their groups right away, and remember to reveal the exit if there is nothing to collect
+    mergeSpawnedActors();
+    m_revealExitPending = (m_crystals == 0);
+    
+    return GWSTATUS_CONTINUE_GAME;
+}
+
+int StudentWorld::prepareLevel()
+{
+    // Parse the level data file only when the level changes; a restart after a lost life reuses the template
+    if (m_levelTemplate == nullptr || m_levelTemplate->level != getLevel())
+    {
+        int result = loadLevelTemplate();
+        
+        if (result != GWSTATUS_CONTINUE_GAME)
+            return result;
+    }
+    
+    const LevelTemplate& level = *m_levelTemplate;
+    
+    // The terrain layer and the attributes it gives each square are copied in whole
+    for (int y = 0; y < VIEW_HEIGHT; y++)
+        for (int x = 0; x < VIEW_WIDTH; x++)
+        {
+            m_terrain[y][x] = level.terrain[y][x];
+            m_squareAttributes[y][x] = level.squareAttributes[y][x];
+        }
+    
+    for (int i = 0; i < Actor::NUM_ATTRIBUTES; i++)
+        m_attributeBoards[i] = level.attributeBoards[i];
+    
+    return GWSTATUS_CONTINUE_GAME;
+}
+
+int StudentWorld::loadLevelTemplate()
+{
+    // Get the name of the current level data file
+    ostringstream oss;
+    oss << "level";
+    oss.fill('0');
+    oss << setw(2) << getLevel();
+    oss << ".txt";
+    
+    // Load the current maze details from the level data file
+    Level lev(assetPath());
+    Level::LoadResult result = lev.loadLevel(oss.str());
+    
+    // Check the result of loading the level data file
+    if (result == Level::load_fail_file_not_found || getLevel() == 100) // If no level data file with the next number is found or
+        return GWSTATUS_PLAYER_WON;                                     // if the level just completed was 99
+    else if (result == Level::load_fail_bad_format)
+        return GWSTATUS_LEVEL_ERROR;
+    
+    // Load was successful, so record the walls and the actors to create, in the order the maze is scanned
+    // A new template is built rather than the old one changed, since forked worlds may still be using the old one
+    std::shared_ptr<LevelTemplate> parsed = std::make_shared<LevelTemplate>();
+    LevelTemplate& level = *parsed;
+    level.level = getLevel();
+    
+    for (int x = 0; x < VIEW_WIDTH; x++)
+        for (int y = 0; y < VIEW_HEIGHT; y++)
+        {
+            Level::MazeEntry item = lev.getContentsOf(x, y);
+            Terrain terrain = (item == Level::wall) ? WALL : OPEN;
+            
+            level.terrain[y][x] = terrain;
+            level.squareAttributes[y][x] = terrainAttributes(terrain);
+            
+            for (int i = 0; i < Actor::NUM_ATTRIBUTES; i++)
+                if (terrainAttributes(terrain) & (1u << i))
+                    level.attributeBoards[i].set(Bitboard::square(x, y));
+            
+            if (item != Level::empty && item != Level::wall)
+            {
+                LevelTemplate::Spawn spawn = { item, static_cast<unsigned char>(x), static_cast<unsigned char>(y) };
+                level.spawns.push_back(spawn);
+            }
+        }
+    
+    m_levelTemplate = parsed;
+    return GWSTATUS_CONTINUE_GAME;
+}
+
+// Order in which the groups of actors act during a tick, after the player
+// Within a group, actors act in the order they were added to the game. Factories go first, so a ThiefBot made
+// by a factory still acts during the tick it appears, and the peas move after every group (see movePeas), so a
+// pea fired by the player or a robot moves during the tick it appears, just as when every actor shared one list.
+// Marbles, collectables, pits and exits are passive: they never act during a tick and only react to events
+// (see onEnter and revealExit), so they have no place in the order.
+static const Actor::Type TICK_ORDER[] = {
+    Actor::THIEFBOT_FACTORY, Actor::MEAN_THIEFBOT_FACTORY,
+    Actor::RAGEBOT, Actor::THIEFBOT, Actor::MEAN_THIEFBOT
+};
+
+// Called every tick
+int StudentWorld::move()
+{
+    // A level without crystals reveals its exit on the first tick
+    if (m_revealExitPending)
+        revealExit();
+    
+    // Give the player a chance to do something
+    Avatar* player = getPlayer();
+    
+    if (player->isAlive())
+    {
+        player->doSomething();
+        
+        int status = tickStatus();
+        if (status != GWSTATUS_CONTINUE_GAME)
+            return status;
+    }
+    
+    // Give all other actors a chance to do something, one group of a single concrete type at a time
+    // Actors spawned during the tick wait in the spawn buffer and join their group before the next group acts
+    for (int i = 0; i != sizeof(TICK_ORDER) / sizeof(TICK_ORDER[0]); i++)
+    {
+        mergeSpawnedActors();
+        
+        int status = tickGroup(TICK_ORDER[i]);
+        if (status != GWSTATUS_CONTINUE_GAME)
+            return status;
+    }
+    
+    mergeSpawnedActors();
+    
+    // Goodies dropped by ThiefBots the peas killed join their group now, so nothing is left in the spawn buffer between ticks
+    int status = movePeas();
+    mergeSpawnedActors();
+    if (status != GWSTATUS_CONTINUE_GAME)
+        return status;
+    
+    // Remove any actors that have died during this tick in a single pass, keeping the survivors in order
+    for (int i = 0; i != Actor::NUM_TYPES; i++)
+        removeDeadActors(m_groups[i]);
+    
+    int survivors = 0;
+    
+    for (int i = 0; i != m_actors.size(); i++)
+        if ( ! m_actors[i]->isAlive())
+        {
+            removeFromCell(m_actors[i], m_actors[i]->getX(), m_actors[i]->getY());
+            releaseHandle(m_actors[i]);
+            destroyActor(m_actors[i]);
+        }
+        else
+            m_actors[survivors++] = m_actors[i];
+    
+    m_actors.resize(survivors);
+    
+    if (m_actorOrder == SPATIAL_ORDER && m_tick % SPATIAL_SORT_INTERVAL == 0)
+        sortActorsSpatially();
+    
+    // Reduce the current bonus for the level by one
+    if (m_bonus > 0)
+        m_bonus--;
+    
+    // Update the game status line
+    updateDisplayText();
+    
+    m_tick++;
+    
+    // The player hasn’t completed the current level and hasn’t died, so continue playing the current level
+    return GWSTATUS_CONTINUE_GAME;
+}
+
+int StudentWorld::tickStatus()
+{
+    // Stop the tick as soon as the player has died or completed the level
+    if ( ! getPlayer()->isAlive())
+    {
+        decLives();
+        return GWSTATUS_PLAYER_DIED;
+    }
+    
+    if (m_completedLevel)
+    {
+        m_completedLevel = false;
+        increaseScore(2000 + m_bonus);
+        return GWSTATUS_FINISHED_LEVEL;
+    }
+    
+    return GWSTATUS_CONTINUE_GAME;
+}
+
+template <class T>
+int StudentWorld::tickScheduled(Actor::Type type)
+{
+    // Only the actors due on this tick are visited, in the order they were scheduled
+    // Each one schedules its next action while it acts, so the due list is taken from the wheel first
+    // Every actor in the wheel is a T, so call T's doSomething directly instead of through the vtable
+    m_due.clear();
+    m_wheels[type].takeDue(m_tick, m_due);
+    
+    for (int i = 0; i != m_due.size(); i++)
+    {
+        Actor* actor = resolve(m_due[i]);
+        
+        if (actor != nullptr && actor->isAlive())
+        {
+            static_cast<T*>(actor)->T::doSomething();
+            
+            int status = tickStatus();
+            if (status != GWSTATUS_CONTINUE_GAME)
+                return status;
+        }
+    }
+    
+    return GWSTATUS_CONTINUE_GAME;
+}
+
+int StudentWorld::tickGroup(Actor::Type type)
+{
+    switch (type)
+    {
+        case Actor::RAGEBOT:                return tickScheduled<RageBot>(type);
+        case Actor::THIEFBOT:               return tickScheduled<ThiefBot>(type);
+        case Actor::MEAN_THIEFBOT:          return tickScheduled<MeanThiefBot>(type);
+        case Actor::THIEFBOT_FACTORY:       return tickScheduled<ThiefBotFactory>(type);
+        case Actor::MEAN_THIEFBOT_FACTORY:  return tickScheduled<MeanThiefBotFactory>(type);
+        default:                            return GWSTATUS_CONTINUE_GAME;
+    }
+}
+
+int StudentWorld::movePeas()
+{
+    // First move every pea and find what it hits, in the order the peas were fired
+    // Damage only changes health, and dead actors keep their squares until the end of the tick, so finding
+    // every hit before applying any of them gives each pea exactly the target it would have hit on its own
+    m_peaHits.clear();
+    int survivors = 0;
+    
+    for (int i = 0; i != m_peas.size(); i++)
+    {
+        int x = m_peas.x[i];
+        int y = m_peas.y[i];
+        int direction = m_peas.direction[i];
+        ActorHandle target;
+        
+        // A pea checks its square before and after taking its step
+        bool stopped = peaStopsAt(x, y, target);
+        
+        if ( ! stopped)
+        {
+            int dx, dy;
+            GraphObject::getDirectionOffset(direction, dx, dy);
+            removePeaFrom(x, y);
+            m_stateHash ^= peaKey(x, y, direction);
+            x += dx;
+            y += dy;
+            addPeaTo(x, y);
+            m_stateHash ^= peaKey(x, y, direction);
+            stopped = peaStopsAt(x, y, target);
+        }
+        
+        if (stopped)
+        {
+            removePeaFrom(x, y);
+            m_stateHash ^= peaKey(x, y, direction);
+            
+            if ( ! target.isNull())
+                m_peaHits.push_back(target);
+        }
+        else
+        {
+            m_peas.x[survivors] = x;
+            m_peas.y[survivors] = y;
+            m_peas.direction[survivors] = direction;
+            survivors++;
+        }
+    }
+    
+    m_peas.resize(survivors);
+    
+    // Then damage everything that was hit in one batch, stopping as soon as the player dies
+    for (int i = 0; i != m_peaHits.size(); i++)
+    {
+        resolve(m_peaHits[i])->damage();
+        
+        int status = tickStatus();
+        if (status != GWSTATUS_CONTINUE_GAME)
+            return status;
+    }
+    
+    return GWSTATUS_CONTINUE_GAME;
+}
+
+bool StudentWorld::peaStopsAt(int x, int y, ActorHandle& target)
+{
+    // A pea stops at the player, at anything that can be attacked (which it damages), or at anything that blocks peas
+    if (getPlayer()->isAt(x, y))
+    {
+        target = m_player;
+        return true;
+    }
+    
+    if ( ! isOnBoard(x, y))
+        return true;
+    
+    unsigned attributes = m_squareAttributes[y][x];
+    
+    if (attributes & Actor::CAN_BE_ATTACKED)
+    {
+        target = actorAt<Actor::CAN_BE_ATTACKED>(x, y);
+        return true;
+    }
+    
+    return (attributes & Actor::BLOCKS_PEA_MOVEMENT) != 0;
+}
+
+void StudentWorld::firePea(int x, int y, int direction)
+{
+    m_peas.add(x, y, direction);
+    addPeaTo(x, y);
+    m_stateHash ^= peaKey(x, y, direction);
+    m_peasFired++;
+}
+
+void StudentWorld::getProjectile(int i, int& imageID, int& x, int& y, int& direction) const
+{
+    imageID = IID_PEA;
+    x = m_peas.x[i];
+    y = m_peas.y[i];
+    direction = m_peas.direction[i];
+}
+
+void StudentWorld::addPeaTo(int x, int y)
+{
+    // Only the first pea on a square changes what occupies it
+    if (isOnBoard(x, y) && m_peaCounts[y][x]++ == 0)
+        refreshSquare(x, y);
+}
+
+void StudentWorld::removePeaFrom(int x, int y)
+{
+    if (isOnBoard(x, y) && --m_peaCounts[y][x] == 0)
+        refreshSquare(x, y);
+}
+
+void StudentWorld::removeDeadActors(vector<Actor*>& group)
+{
+    // Only drops the pointers; the actors themselves are freed by the compaction of m_actors
+    int survivors = 0;
+    
+    for (int i = 0; i != group.size(); i++)
+        if (group[i]->isAlive())
+            group[survivors++] = group[i];
+    
+    group.resize(survivors);
+}
+
+void StudentWorld::scheduleAction(Actor* actor, int tick)
+{
+    m_wheels[actor->getType()].schedule(actor->getHandle(), tick);
+}
+
+void StudentWorld::assignHandle(Actor* actor)
+{
+    // Reuse a freed slot if there is one, keeping its generation so older handles to it stay stale
+    uint32_t index;
+    
+    if ( ! m_freeSlots.empty())
+    {
+        index = m_freeSlots.back();
+        m_freeSlots.pop_back();
+    }
+    else
+    {
+        index = static_cast<uint32_t>(m_slots.size());
+        Slot slot = { nullptr, 1, 0 };
+        m_slots.push_back(slot);
+    }
+    
+    m_slots[index].actor = actor;
+    actor->setHandle(ActorHandle(index, m_slots[index].generation));
+    
+    // From now on the actor is part of the state hash
+    m_slots[index].stateKey = actorKey(actor);
+    m_stateHash ^= m_slots[index].stateKey;
+}
 
-StudentWorld::~StudentWorld()
+void StudentWorld::releaseHandle(Actor* actor)
+{
+    // Generation 0 is never used, so a handle can never match a slot that wrapped around to it
+    Slot& slot = m_slots[actor->getHandle().index()];
+    m_stateHash ^= slot.stateKey;
+    slot.actor = nullptr;
+    slot.generation = (slot.generation + 1) & ActorHandle::GENERATION_MASK;
+    
+    if (slot.generation == 0)
+        slot.generation = 1;
+    
+    m_freeSlots.push_back(actor->getHandle().index());
+    actor->setHandle(ActorHandle());
+}
+
+Actor* StudentWorld::resolve(ActorHandle handle) const
+{
+    if (handle.isNull() || handle.index() >= m_slots.size())
+        return nullptr;
+    
+    const Slot& slot = m_slots[handle.index()];
+    return slot.generation == handle.generation() ? slot.actor : nullptr;
+}
+
+void StudentWorld::scheduleFirstAction(Actor* actor)
 {
-    // Frees all actors currently in the game and removes them from the actor vector
-    for (vector<Actor*>::iterator it = m_actors.begin(); it != m_actors.end(); )
+    switch (actor->getType())
     {
-        delete *it;
-        it = m_actors.erase(it);
+        case Actor::RAGEBOT:
+        case Actor::THIEFBOT:
+        case Actor::MEAN_THIEFBOT:
+        {
+            // A new robot counts the tick it appears on as its first tick of rest
+            Robot* robot = static_cast<Robot*>(actor);
+            robot->scheduleActionAt(m_tick + robot->getRestTicks() - 1);
+            break;
+        }
+        case Actor::THIEFBOT_FACTORY:
+        case Actor::MEAN_THIEFBOT_FACTORY:
+            // The factory's first roll is on the tick it appears
+            static_cast<ThiefBotFactory*>(actor)->scheduleNextBirth(m_tick - 1);
+            break;
+        default:
+            break;
     }
-    
-    // Prevent any bugs involving double-deleting by immediately setting m_avatar to nullptr
-    delete m_avatar;
-    m_avatar = nullptr;
 }
 
-int StudentWorld::init()
+void StudentWorld::cleanUp()
 {
-    // Get the name of the current level data file
-    ostringstream oss;
-    oss << "level";
-    oss.fill('0');
-    oss << setw(2) << getLevel();
-    oss << ".txt";
+    resetAllocationCounts();
+    clearActors();
+}
+
+StudentWorld::AllocationCounts StudentWorld::getAllocationCounts() const
+{
+    AllocationCounts counts = { m_thiefBotPool.made(), m_thiefBotPool.fromHeap(), m_meanThiefBotPool.made(), m_meanThiefBotPool.fromHeap(), m_peasFired };
+    return counts;
+}
+
+void StudentWorld::resetAllocationCounts()
+{
+    m_thiefBotPool.resetCounts();
+    m_meanThiefBotPool.resetCounts();
+    m_peasFired = 0;
+}
+
+void StudentWorld::clearActors()
+{
+    // Frees all actors currently in the game (including any still waiting to be merged) and empties the actor vector
+    mergeSpawnedActors();
     
-    // Load the current maze details from the level data file
-    Level lev(assetPath());
-    Level::LoadResult result = lev.loadLevel(oss.str());
+    for (vector<Actor*>::iterator it = m_actors.begin(); it != m_actors.end(); it++)
+    {
+        releaseHandle(*it);
+        destroyActor(*it);
+    }
     
-    // Check the result of loading the level data file
-    if (result == Level::load_fail_file_not_found || getLevel() == 100) // If no level data file with the next number is found or
-        return GWSTATUS_PLAYER_WON;                                     // if the level just completed was 99
-    else if (result == Level::load_fail_bad_format)
-        return GWSTATUS_LEVEL_ERROR;
-    else if (result == Level::load_success)
+    m_actors.clear();
+    m_peas.clear();
+    
+    for (int i = 0; i != Actor::NUM_TYPES; i++)
     {
-        // Load was successful and we can start inserting objects into the maze
-        
-        m_crystals = 0;
-        
-        // Allocate and insert actors into the game world, as required by the specification in the current level’s data file
+        m_groups[i].clear();
+        m_wheels[i].clear();
+    }
+    
+    // Every actor is gone, so every square of the grid is empty
+    for (int y = 0; y < VIEW_HEIGHT; y++)
         for (int x = 0; x < VIEW_WIDTH; x++)
-            for (int y = 0; y < VIEW_HEIGHT; y++)
-            {
-                Level::MazeEntry item = lev.getContentsOf(x, y);
-                
-                switch (item)
-                {
-                    // Locations where the player and robots may walk within the maze
-                    case Level::empty:
-                        break;
-                    case Level::exit:
-                        m_actors.push_back(new Exit(this, x, y));
-                        break;
-                    case Level::player:
-                        m_avatar = new Avatar(this, x, y);
-                        break;
-                    case Level::horiz_ragebot:
-                        m_actors.push_back(new RageBot(this, x, y));
-                        break;
-                    case Level::vert_ragebot:
-                        m_actors.push_back(new RageBot(this, x, y, 270));
-                        break;
-                    case Level::thiefbot_factory:
-                        m_actors.push_back(new ThiefBotFactory(this, x, y));
-                        break;
-                    case Level::mean_thiefbot_factory:
-                        m_actors.push_back(new MeanThiefBotFactory(this, x, y));
-                        break;
-                    case Level::wall:
-                        m_actors.push_back(new Wall(this, x, y));
-                        break;
-                    case Level::marble:
-                        m_actors.push_back(new Marble(this, x, y));
-                        break;
-                    case Level::pit:
-                        m_actors.push_back(new Pit(this, x, y));
-                        break;
-                    case Level::crystal:
-                        m_actors.push_back(new Crystal(this, x, y));
-                        m_crystals++;
-                        break;
-                    case Level::restore_health:
-                        m_actors.push_back(new RestoreHealthGoodie(this, x, y));
-                        break;
-                    case Level::extra_life:
-                        m_actors.push_back(new ExtraLifeGoodie(this, x, y));
-                        break;
-                    case Level::ammo:
-                        m_actors.push_back(new AmmoGoodie(this, x, y));
-                        break;
-                }
-            }
+        {
+            m_grid[y][x].clear();
+            m_peaCounts[y][x] = 0;
+            m_terrain[y][x] = OPEN;
+            m_squareAttributes[y][x] = 0;
+        }
+    
+    for (int i = 0; i < Actor::NUM_ATTRIBUTES; i++)
+        m_attributeBoards[i].clear();
+    m_playerSightValid = false;
+    
+    // Prevent any bugs involving double-deleting by immediately forgetting the player's handle
+    Avatar* player = getPlayer();
+    
+    if (player != nullptr)
+    {
+        releaseHandle(player);
+        destroyActor(player);
     }
     
-    // The result == Level::load_success branch was taken
+    m_player = ActorHandle();
     
-    // Start the bonus points at 1000
-    m_bonus = INITIAL_BONUS;
+    // With every actor and pea gone, nothing is left in the state hash
+    m_stateHash = 0;
     
-    return GWSTATUS_CONTINUE_GAME;
+    // Every actor init built has been destroyed, so the arena's memory can be handed out again
+    m_levelArena.release();
 }
 
-// Called every tick
-int StudentWorld::move()
+void StudentWorld::addActor(Actor* actor)
 {
-    // Give the player a chance to do something
-    if (m_avatar->isAlive())
+    // The actor is on the board (and visible to queries) right away, but joins m_actors only when the spawn buffer is merged
+    m_spawned.push_back(actor);
+    assignHandle(actor);
+    addToCell(actor, actor->getX(), actor->getY());
+}
+
+ThiefBot* StudentWorld::newThiefBot(int x, int y)
+{
+    return m_thiefBotPool.create(this, Actor::THIEFBOT, THIEFBOT_INITIAL_HEALTH, IID_THIEFBOT, x, y);
+}
+
+MeanThiefBot* StudentWorld::newMeanThiefBot(int x, int y)
+{
+    return m_meanThiefBotPool.create(this, x, y);
+}
+
+Actor* StudentWorld::newGoodie(Actor::Type type, int x, int y)
+{
+    // Goodies are only dropped when a ThiefBot dies, so the few made after init can share the arena until the level ends
+    switch (type)
+    {
+        case Actor::EXTRA_LIFE_GOODIE:      return m_levelArena.create<ExtraLifeGoodie>(this, x, y);
+        case Actor::RESTORE_HEALTH_GOODIE:  return m_levelArena.create<RestoreHealthGoodie>(this, x, y);
+        case Actor::AMMO_GOODIE:            return m_levelArena.create<AmmoGoodie>(this, x, y);
+        default:                            return nullptr;
+    }
+}
+
+void StudentWorld::destroyActor(Actor* actor)
+{
+    switch (actor->getType())
+    {
+        case Actor::THIEFBOT:
+            m_thiefBotPool.destroy(static_cast<ThiefBot*>(actor));
+            break;
+        case Actor::MEAN_THIEFBOT:
+            m_meanThiefBotPool.destroy(static_cast<MeanThiefBot*>(actor));
+            break;
+        default:
+            // Every other actor, including goodies dropped mid-level, lives in the level's arena, which frees their
+            // memory all at once when the level ends
+            assert(m_levelArena.owns(actor));
+            actor->~Actor();
+            break;
+    }
+}
+
+void StudentWorld::setActorOrder(ActorOrder order)
+{
+    m_actorOrder = order;
+    
+    if (order == SPATIAL_ORDER)
+        sortActorsSpatially();
+}
+
+// Spreads the low 8 bits of n out to the even bits of the result
+static unsigned spreadBits(unsigned n)
+{
+    n &= 0xFF;
+    n = (n | n << 4) & 0x0F0F;
+    n = (n | n << 2) & 0x3333;
+    n = (n | n << 1) & 0x5555;
+    return n;
+}
+
+// Interleaves the bits of x and y (a Morton code), so squares close together on the board get close codes
+static unsigned mortonCode(int x, int y)
+{
+    return spreadBits(x) | spreadBits(y) << 1;
+}
+
+void StudentWorld::sortActorsSpatially()
+{
+    // Sort the actors by the Morton code of their squares, breaking ties by their place in m_actors (the player last),
+    // so the result never depends on the sort itself; from then on each actor is found through its slot
+    Avatar* player = getPlayer();
+    m_spatialKeys.clear();
+    
+    for (int i = 0; i != m_actors.size(); i++)
+        m_spatialKeys.push_back(uint64_t(mortonCode(m_actors[i]->getX(), m_actors[i]->getY())) << 32 | i);
+    
+    if (player != nullptr)
+        m_spatialKeys.push_back(uint64_t(mortonCode(player->getX(), player->getY())) << 32 | m_actors.size());
+    
+    sort(m_spatialKeys.begin(), m_spatialKeys.end());
+    m_spatialSlots.clear();
+    
+    for (int i = 0; i != m_spatialKeys.size(); i++)
+    {
+        uint32_t place = uint32_t(m_spatialKeys[i]);
+        m_spatialSlots.push_back((place < m_actors.size() ? m_actors[place] : player)->getHandle().index());
+    }
+    
+    // ThiefBots have to stay in their pools, so they trade blocks instead
+    sortPooledActors<ThiefBot>(Actor::THIEFBOT);
+    sortPooledActors<MeanThiefBot>(Actor::MEAN_THIEFBOT);
+    
+    // Every other actor is copied in Z order into a fresh arena (copyActor makes its copies in the level's arena)
+    m_levelArena.swap(m_spareArena);
+    
+    for (int i = 0; i != m_spatialSlots.size(); i++)
     {
-        m_avatar->doSomething();
+        Actor* actor = m_slots[m_spatialSlots[i]].actor;
         
-        if ( ! m_avatar->isAlive())
-        {
-            decLives();
-            return GWSTATUS_PLAYER_DIED;
-        }
+        if (actor->getType() != Actor::THIEFBOT && actor->getType() != Actor::MEAN_THIEFBOT)
+            moveActor(actor, copyActor(actor));
+    }
+    
+    finishMoves();
+    m_spareArena.release();
+    
+    // The end-of-tick pass walks the actors in Z order too
+    m_actors.clear();
+    
+    for (int i = 0; i != m_spatialSlots.size(); i++)
+        if (m_spatialSlots[i] != m_player.index())
+            m_actors.push_back(m_slots[m_spatialSlots[i]].actor);
+}
+
+template <class T>
+void StudentWorld::sortPooledActors(Actor::Type type)
+{
+    // The pool's objects in Z order get the blocks they already hold in address order
+    m_poolBlocks.clear();
+    
+    for (int i = 0; i != m_spatialSlots.size(); i++)
+        if (m_slots[m_spatialSlots[i]].actor->getType() == type)
+            m_poolBlocks.push_back(static_cast<T*>(m_slots[m_spatialSlots[i]].actor));
+    
+    sort(m_poolBlocks.begin(), m_poolBlocks.end(), less<void*>());
+    
+    // A block may still hold another of the objects, so every object is parked in the spare arena first
+    for (int i = 0; i != m_spatialSlots.size(); i++)
+    {
+        Actor* actor = m_slots[m_spatialSlots[i]].actor;
         
-        if (m_completedLevel)
-        {
-            m_completedLevel = false;
-            increaseScore(2000 + m_bonus);
-            return GWSTATUS_FINISHED_LEVEL;
-        }
+        if (actor->getType() == type)
+            moveActor(actor, m_spareArena.create<T>(*static_cast<T*>(actor)));
     }
     
-    // Give all other actors a chance to do something
-    for (int i = 0; i != m_actors.size(); i++)
-        if (m_actors[i]->isAlive())
-        {
-            m_actors[i]->doSomething();
-            
-            if ( ! m_avatar->isAlive())
-            {
-                decLives();
-                return GWSTATUS_PLAYER_DIED;
-            }
-            
-            if (m_completedLevel)
-            {
-                m_completedLevel = false;
-                increaseScore(2000 + m_bonus);
-                return GWSTATUS_FINISHED_LEVEL;
-            }
-        }
+    finishMoves();
+    
+    for (int i = 0, block = 0; i != m_spatialSlots.size(); i++)
+    {
+        Actor* parked = m_slots[m_spatialSlots[i]].actor;
         
-    // Remove any actors that have died during this tick
-    for (vector<Actor*>::iterator it = m_actors.begin(); it != m_actors.end(); )
-        if ( ! (*it)->isAlive())
-        {
-            delete *it;
-            it = m_actors.erase(it);
-        }
-        else
-            it++;
+        if (parked->getType() == type)
+            moveActor(parked, new (m_poolBlocks[block++]) T(*static_cast<T*>(parked)));
+    }
     
-    // Reduce the current bonus for the level by one
-    if (m_bonus > 0)
-        m_bonus--;
+    finishMoves();
+    m_spareArena.release();
+}
+
+void StudentWorld::moveActor(Actor* from, Actor* to)
+{
+    // The copy takes over the original's slot, so handles find it, and its place in the registry, so it is drawn instead
+    to->takeRegistrationFrom(*from);
+    m_slots[from->getHandle().index()].actor = to;
+    m_movedFrom.push_back(from);
+}
+
+void StudentWorld::finishMoves()
+{
+    // Every list still holds the originals, which are still alive, so each entry can be swapped for the actor in its slot
+    copyActorList(m_actors, m_actors);
+    copyActorList(m_spawned, m_spawned);
     
-    // Update the game status line
-    updateDisplayText();
+    for (int i = 0; i != Actor::NUM_TYPES; i++)
+        copyActorList(m_groups[i], m_groups[i]);
     
-    // The player hasn’t completed the current level and hasn’t died, so continue playing the current level
-    return GWSTATUS_CONTINUE_GAME;
+    for (int y = 0; y < VIEW_HEIGHT; y++)
+        for (int x = 0; x < VIEW_WIDTH; x++)
+            copyActorList(m_grid[y][x], m_grid[y][x]);
+    
+    // The originals' memory is either the old arena, released as a whole, or a pool block that a copy is about to reuse
+    for (int i = 0; i != m_movedFrom.size(); i++)
+        m_movedFrom[i]->~Actor();
+    
+    m_movedFrom.clear();
 }
 
-void StudentWorld::cleanUp()
+void StudentWorld::takeOffBoard(Actor* actor)
+{
+    // The actor disappears from the board and from every query right away, and is freed with the other dead actors
+    actor->setVisible(false);
+    actor->setStatus(DEAD);
+    removeFromCell(actor, actor->getX(), actor->getY());
+}
+
+void StudentWorld::mergeSpawnedActors()
 {
-    // Frees all actors currently in the game and removes them from the actor vector
-    for (vector<Actor*>::iterator it = m_actors.begin(); it != m_actors.end(); )
+    for (int i = 0; i != m_spawned.size(); i++)
     {
-        delete *it;
-        it = m_actors.erase(it);
+        joinGroup(m_spawned[i]);
+        scheduleFirstAction(m_spawned[i]);
     }
     
-    // Prevent any bugs involving double-deleting by immediately setting m_avatar to nullptr
-    delete m_avatar;
-    m_avatar = nullptr;
+    m_spawned.clear();
 }
 
-void StudentWorld::updateDisplayText()
+void StudentWorld::joinGroup(Actor* actor)
 {
-    ostringstream oss;
-    oss.fill('0');
-    oss << "Score: " << setw(7) << getScore();
-    oss << "  Level: " << setw(2) << getLevel();
-    oss.fill(' ');
-    oss << "  Lives: " << setw(2) << getLives();
-    oss << "  Health: " << setw(3) << (m_avatar->getHealth() / 20.0) * 100 << '%';
-    oss << "  Ammo: " << setw(3) << m_avatar->getAmmo();
-    oss << "  Bonus: " << setw(4) << m_bonus;
-    setGameStatText(oss.str());
+    m_actors.push_back(actor);
+    m_groups[actor->getType()].push_back(actor);
+    
+    // From now on the factory's census is updated as ThiefBots come and go
+    if (actor->getType() == Actor::THIEFBOT_FACTORY || actor->getType() == Actor::MEAN_THIEFBOT_FACTORY)
+        static_cast<ThiefBotFactory*>(actor)->takeCensus();
 }
 
-bool StudentWorld::hasCollectedAllCrystals() const
+void StudentWorld::actorChanged(const Actor* actor)
 {
-    // If the total crystals in the maze == the number of crystals the player has
-    return (m_crystals == m_avatar->getCrystals());
+    // Swap the actor's old key in the state hash for its new one (actors get their first key along with their handle)
+    ActorHandle handle = actor->getHandle();
+    
+    if (handle.isNull())
+        return;
+    
+    Slot& slot = m_slots[handle.index()];
+    uint64_t key = actorKey(actor);
+    m_stateHash ^= slot.stateKey ^ key;
+    slot.stateKey = key;
 }
 
-Actor* StudentWorld::blocksMovementAt(double x, double y)
+// The kinds of state that make up the state hash, so equal numbers in different kinds of state get different keys
+enum StateKind { ACTOR_STATE, ROBOT_STATE, THIEFBOT_STATE, PEA_STATE, BONUS_STATE, CRYSTALS_LEFT_STATE, AMMO_STATE, CRYSTALS_HELD_STATE, RANDOM_STATE };
+
+// Pseudo-random key for one piece of state, as in Zobrist hashing, but made by mixing the state's bits
+// (with the splitmix64 finalizer) instead of looked up in a table, so any value of any state has a key
+static uint64_t stateKey(uint64_t kind, uint64_t value)
 {
-    for (int i = 0; i != m_actors.size(); i++)
-        if (m_actors[i]->isAt(x, y) && m_actors[i]->blocksMovement())
-            return m_actors[i];
+    uint64_t z = value ^ (kind + 1) * 0x9e3779b97f4a7c15ULL;
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+uint64_t StudentWorld::actorKey(const Actor* actor)
+{
+    // Dead actors no longer count, so an actor's death takes it out of the hash before it is even removed
+    if ( ! actor->isAlive())
+        return 0;
     
-    return nullptr;
+    int health = actor->hasAttribute(Actor::CAN_BE_ATTACKED) ? static_cast<const CanBeAttacked*>(actor)->getHealth() : 0;
+    bool revealed = actor->getType() == Actor::EXIT && static_cast<const Exit*>(actor)->isRevealed();
+    uint64_t state = uint64_t(revealed) << 56 | uint64_t(actor->getType()) << 48 | uint64_t(actor->getX() & 0xFF) << 40
+                   | uint64_t(actor->getY() & 0xFF) << 32 | uint64_t(actor->getDirection() & 0xFFFF) << 16 | uint64_t(health & 0xFFFF);
+    
+    // The plans of robots and factories don't fit in the same 64 bits, so they get a key of their own that is mixed
+    // into the actor's (rather than XORed alongside it, which would let two robots swap plans without changing the hash)
+    switch (actor->getType())
+    {
+        case Actor::RAGEBOT:
+            state ^= stateKey(ROBOT_STATE, uint32_t(static_cast<const Robot*>(actor)->getNextTick()));
+            break;
+        case Actor::THIEFBOT:
+        case Actor::MEAN_THIEFBOT:
+        {
+            const ThiefBot* thiefBot = static_cast<const ThiefBot*>(actor);
+            state ^= stateKey(ROBOT_STATE, uint64_t(thiefBot->getCarriedGoodie()) << 32 | uint32_t(thiefBot->getNextTick()))
+                   ^ stateKey(THIEFBOT_STATE, uint64_t(uint32_t(thiefBot->getRollsBeforeSteal())) << 32
+                                            | uint64_t(thiefBot->getDistanceBeforeTurning() & 0xFFFF) << 16
+                                            | uint64_t(thiefBot->getDistanceTraveled() & 0xFFFF));
+            break;
+        }
+        case Actor::THIEFBOT_FACTORY:
+        case Actor::MEAN_THIEFBOT_FACTORY:
+            state ^= stateKey(ROBOT_STATE, uint32_t(static_cast<const ThiefBotFactory*>(actor)->getNextBirthTick()));
+            break;
+        default:
+            break;
+    }
+    
+    return stateKey(ACTOR_STATE, state);
 }
 
-Actor* StudentWorld::canBePushedAt(double x, double y)
+uint64_t StudentWorld::peaKey(int x, int y, int direction)
 {
-    for (int i = 0; i != m_actors.size(); i++)
-        if (m_actors[i]->isAt(x, y) && m_actors[i]->canBePushed())
-            return m_actors[i];
+    return stateKey(PEA_STATE, uint64_t(x & 0xFF) << 40 | uint64_t(y & 0xFF) << 32 | uint64_t(direction & 0xFFFF) << 16);
+}
+
+uint64_t StudentWorld::getStateHash() const
+{
+    // The actors and peas are kept in m_stateHash as they change; the handful of numbers left are mixed in here
+    // (m_crystals is the level's total, so the crystals left are what the player has yet to collect)
+    uint64_t hash = m_stateHash ^ stateKey(BONUS_STATE, m_bonus);
+    Avatar* player = getPlayer();
     
-    return nullptr;
+    if (player != nullptr)
+        hash ^= stateKey(AMMO_STATE, player->getAmmo()) ^ stateKey(CRYSTALS_HELD_STATE, player->getCrystals())
+              ^ stateKey(CRYSTALS_LEFT_STATE, m_crystals - player->getCrystals());
+    
+    for (int i = 0; i < 4; i++)
+        hash ^= stateKey(RANDOM_STATE + i, m_random.getState(i));
+    
+    return hash;
 }
 
-Actor* StudentWorld::stolenByThiefBotsAt(double x, double y)
+void StudentWorld::updateActorCell(Actor* actor, int oldX, int oldY)
 {
-    for (int i = 0; i != m_actors.size(); i++)
-        if (m_actors[i]->isAt(x, y) && m_actors[i]->stolenByThiefBots())
-            return m_actors[i];
+    if (actor->isAt(oldX, oldY))
+        return;
     
-    return nullptr;
+    // The player is tracked separately from the other actors and never enters the grid
+    if (actor->getHandle() != m_player)
+    {
+        removeFromCell(actor, oldX, oldY);
+        addToCell(actor, actor->getX(), actor->getY());
+    }
+    else
+        m_playerSightValid = false;
+    
+    // Let anything on the new square react to the arrival (ex: a goodie to the player, a pit to a marble)
+    if ( ! hasAttributeAt<Actor::REACTS_TO_VISITORS>(actor->getX(), actor->getY()))
+        return;
+    
+    const vector<Actor*>& cell = occupantsAt(actor->getX(), actor->getY());
+    
+    for (int i = 0; i != cell.size(); i++)
+        if (cell[i] != actor && cell[i]->hasAttribute(Actor::REACTS_TO_VISITORS))
+            cell[i]->onEnter(actor);
 }
 
-Actor* StudentWorld::allowsMarbleMovementAt(double x, double y)
+void StudentWorld::revealExit()
 {
-    for (int i = 0; i != m_actors.size(); i++)
-        if (m_actors[i]->isAt(x, y) && m_actors[i]->allowsMarbleMovement())
-            return m_actors[i];
+    m_revealExitPending = false;
     
-    return nullptr;
+    for (int i = 0; i != m_groups[Actor::EXIT].size(); i++)
+        static_cast<Exit*>(m_groups[Actor::EXIT][i])->reveal();
 }
 
-Actor* StudentWorld::countedByFactoriesAt(double x, double y)
+const vector<Actor*>& StudentWorld::occupantsAt(int x, int y) const
 {
-    for (int i = 0; i != m_actors.size(); i++)
-        if (m_actors[i]->isAt(x, y) && m_actors[i]->countedByFactories())
-            return m_actors[i];
+    // Squares off the board never hold anything
+    static const vector<Actor*> outside;
     
-    return nullptr;
+    if ( ! isOnBoard(x, y))
+        return outside;
+    
+    return m_grid[y][x];
 }
 
-Actor* StudentWorld::canBeSwallowedAt(double x, double y)
+void StudentWorld::addToCell(Actor* actor, int x, int y)
 {
-    for (int i = 0; i != m_actors.size(); i++)
-        if (m_actors[i]->isAt(x, y) && m_actors[i]->canBeSwallowed())
-            return m_actors[i];
+    if ( ! isOnBoard(x, y))
+        return;
     
-    return nullptr;
+    m_grid[y][x].push_back(actor);
+    refreshSquare(x, y);
 }
 
-Actor* StudentWorld::canBeAttackedAt(double x, double y)
+void StudentWorld::removeFromCell(Actor* actor, int x, int y)
 {
-    for (int i = 0; i != m_actors.size(); i++)
-        if (m_actors[i]->isAt(x, y) && m_actors[i]->canBeAttacked())
-            return m_actors[i];
+    if ( ! isOnBoard(x, y))
+        return;
     
-    return nullptr;
+    vector<Actor*>& cell = m_grid[y][x];
+    
+    for (vector<Actor*>::iterator it = cell.begin(); it != cell.end(); it++)
+        if (*it == actor)
+        {
+            cell.erase(it);
+            refreshSquare(x, y);
+            return;
+        }
 }
 
-Actor* StudentWorld::blocksPeaMovementAt(double x, double y)
+void StudentWorld::refreshSquare(int x, int y)
 {
-    for (int i = 0; i != m_actors.size(); i++)
-        if (m_actors[i]->isAt(x, y) && m_actors[i]->blocksPeaMovement())
-            return m_actors[i];
+    // Recombine the attributes of the square's terrain and occupants and flip only the bitboard bits that changed
+    const vector<Actor*>& cell = m_grid[y][x];
+    unsigned attributes = terrainAttributes(m_terrain[y][x]);
     
-    return nullptr;
+    if (m_peaCounts[y][x] != 0)
+        attributes |= Actor::OCCUPIES_SQUARE;
+    
+    for (int i = 0; i != cell.size(); i++)
+        attributes |= cell[i]->getAttributes();
+    
+    unsigned changed = attributes ^ m_squareAttributes[y][x];
+    m_squareAttributes[y][x] = attributes;
+    
+    for (int i = 0; i < Actor::NUM_ATTRIBUTES; i++)
+        if (changed & (1u << i))
+        {
+            if (attributes & (1u << i))
+                m_attributeBoards[i].set(Bitboard::square(x, y));
+            else
+                m_attributeBoards[i].reset(Bitboard::square(x, y));
+        }
+    
+    if (changed & Actor::BLOCKS_ROBOT_SIGHT)
+        m_playerSightValid = false;
+    
+    if (changed & Actor::COUNTED_BY_FACTORIES)
+        updateFactoryCensus(x, y, (attributes & Actor::COUNTED_BY_FACTORIES) ? 1 : -1);
 }
 
-Actor* StudentWorld::anyActorAt(double x, double y)
+void StudentWorld::updateFactoryCensus(int x, int y, int delta)
 {
-    for (int i = 0; i != m_actors.size(); i++)
-        if (m_actors[i]->isAt(x, y))
-            return m_actors[i];
+    // A square gained its first ThiefBot or lost its last one, which changes the census of every factory near it
+    // There are only ever a few factories, so checking each one is cheaper than any area count
+    static const Actor::Type FACTORY_TYPES[] = { Actor::THIEFBOT_FACTORY, Actor::MEAN_THIEFBOT_FACTORY };
     
-    return nullptr;
+    for (int t = 0; t != 2; t++)
+        for (int i = 0; i != m_groups[FACTORY_TYPES[t]].size(); i++)
+        {
+            ThiefBotFactory* factory = static_cast<ThiefBotFactory*>(m_groups[FACTORY_TYPES[t]][i]);
+            
+            if (factory->isInCensusArea(x, y))
+                factory->changeCensus(delta);
+        }
 }
 
-Actor* StudentWorld::blocksRobotSightAt(double x, double y)
+void StudentWorld::updateDisplayText()
 {
-    for (int i = 0; i != m_actors.size(); i++)
-        if (m_actors[i]->isAt(x, y) && m_actors[i]->blocksRobotSight())
-            return m_actors[i];
+    ostringstream oss;
+    oss.fill('0');
+    oss << "Score: " << setw(7) << getScore();
+    oss << "  Level: " << setw(2) << getLevel();
+    oss.fill(' ');
+    oss << "  Lives: " << setw(2) << getLives();
+    oss << "  Health: " << setw(3) << (getPlayer()->getHealth() / 20.0) * 100 << '%';
+    oss << "  Ammo: " << setw(3) << getPlayer()->getAmmo();
+    oss << "  Bonus: " << setw(4) << m_bonus;
+    setGameStatText(oss.str());
+}
+
+int StudentWorld::getTerrainImageAt(int x, int y) const
+{
+    return m_terrain[y][x] == WALL ? IID_WALL : IID_NONE;
+}
+
+bool StudentWorld::hasCollectedAllCrystals() const
+{
+    // If the total crystals in the maze == the number of crystals the player has
+    return (m_crystals == getPlayer()->getCrystals());
+}
+
+unsigned StudentWorld::attributesAt(int x, int y) const
+{
+    if ( ! isOnBoard(x, y))
+        return 0;
     
-    return nullptr;
+    return m_squareAttributes[y][x];
 }
 
-bool StudentWorld::blocksRobotSightBetween(double robotX, double robotY, double playerX, double playerY)
+bool StudentWorld::canSeePlayerFrom(int x, int y)
 {
-    if (robotX < playerX)         // Robot facing right
-    {
-        for (int startX = robotX + 1; startX <= playerX - 1; startX++)
-            if (blocksRobotSightAt(startX, robotY) != nullptr)
-                return true;
-    }
-    else if (robotX > playerX)    // Robot facing left
-    {
-        for (int startX = playerX + 1; startX <= robotX - 1; startX++)
-            if (blocksRobotSightAt(startX, robotY) != nullptr)
-                return true;
-    }
-    else if (robotY < playerY)    // Robot facing up
-    {
-        for (int startY = robotY + 1; startY <= playerY - 1; startY++)
-            if (blocksRobotSightAt(robotX, startY) != nullptr)
-                return true;
-    }
-    else if (robotY > playerY)    // Robot facing down
+    if ( ! m_playerSightValid)
+        computePlayerSight();
+    
+    return isOnBoard(x, y) && m_playerSight.test(Bitboard::square(x, y));
+}
+
+void StudentWorld::computePlayerSight()
+{
+    // Sweep outward from the player in each direction, stopping at the first sight blocker
+    // The blocker itself is included, since nothing stands between it and the player
+    m_playerSight.clear();
+    
+    const Avatar* player = getPlayer();
+    static const int DIRECTIONS[] = { GraphObject::right, GraphObject::left, GraphObject::up, GraphObject::down };
+    
+    for (int d = 0; d != 4; d++)
     {
-        for (int startY = playerY + 1; startY <= robotY - 1; startY++)
-            if (blocksRobotSightAt(robotX, startY) != nullptr)
-                return true;
+        int dx, dy;
+        GraphObject::getDirectionOffset(DIRECTIONS[d], dx, dy);
+        
+        for (int x = player->getX() + dx, y = player->getY() + dy; isOnBoard(x, y); x += dx, y += dy)
+        {
+            m_playerSight.set(Bitboard::square(x, y));
+            
+            if (m_squareAttributes[y][x] & Actor::BLOCKS_ROBOT_SIGHT)
+                break;
+        }
     }
     
-    return false;
+    m_playerSightValid = true;
 }
@@ -1,4 +1,5 @@
 #include "GameController.h"
+#include "GameWorld.h"
 #include <iostream>
 #include <fstream>
 #include <string>
@@ -57,5 +58,18 @@ int main(int argc, char* argv[])
 	}
 
 	GameWorld* gw = createStudentWorld(assetPath);
+
+	  // "-seed <number>" replays the same game every time; the option is removed before GLUT sees the arguments
+	for (int i = 1; i + 1 < argc; i++)
+	{
+		if (string(argv[i]) != "-seed")
+			continue;
+		gw->setRandomSeed(strtoull(argv[i + 1], nullptr, 10));
+		for (int j = i; j + 2 <= argc; j++)
+			argv[j] = argv[j + 2];
+		argc -= 2;
+		break;
+	}
+
 	Game().run(argc, argv, gw, "Marble Madness", msPerTick);
 }